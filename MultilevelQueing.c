@@ -1,547 +1,1317 @@
-#include <gtk/gtk.h>
-#include <string.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <windows.h>
-
-#define MAX_PROCESSES 20
-#define MAX_TIMELINE 200
-#define NUM_QUEUES 3
-
-
-typedef struct {
-char name[10];
-int arrival_time;
-int burst_time;
-int remaining_time;
-int priority;
-int original_priority;
-int time_in_queue;
-int time_executing;
-int completion_time;
-int turnaround_time;
-int waiting_time;
-int response_time;
-gboolean has_started;
-} Process;
-
-
-typedef struct {
-char process_name[10];
-int start_time;
-int duration;
-int queue_level;
-} TimelineEntry;
-
-
-Process processes[MAX_PROCESSES];
-int process_count = 7;
-int current_time = 0;
-TimelineEntry timeline[MAX_TIMELINE];
-int timeline_count = 0;
-
-// Configurable parameters
-int aging_threshold = 5;
-int decrease_threshold = 3;
-int time_quantum[NUM_QUEUES] = {2, 4, 8};
-
-GtkWidget *drawing_area;
-GtkWidget *info_label;
-GtkWidget *time_label;
-GtkWidget *aging_entry;
-GtkWidget *decrease_entry;
-GtkWidget *tq_entries[NUM_QUEUES];
-
-GtkWidget *process_entries[MAX_PROCESSES][3];
-
-// Initialize default process values
-void init_default_processes() {
-    const int default_data[][3] = {
-        {1, 20, 3},   // P1: AT=1, BT=20, Priority=3
-        {3, 10, 2},   // P2: AT=3, BT=10, Priority=2
-        {5, 2, 1},    // P3: AT=5, BT=2, Priority=1
-        {8, 7, 2},    // P4: AT=8, BT=7, Priority=2
-        {11, 15, 3},  // P5: AT=11, BT=15, Priority=3
-        {15, 8, 2},   // P6: AT=15, BT=8, Priority=2
-        {20, 4, 1}    // P7: AT=20, BT=4, Priority=1
-    };
-    
-    for (int i = 0; i < 7; i++) {
-        sprintf(processes[i].name, "P%d", i + 1);
-        processes[i].arrival_time = default_data[i][0];
-        processes[i].burst_time = default_data[i][1];
-        processes[i].remaining_time = default_data[i][1];
-        processes[i].priority = default_data[i][2];
-        processes[i].original_priority = default_data[i][2];
-        processes[i].time_in_queue = 0;
-        processes[i].time_executing = 0;
-        processes[i].completion_time = 0;
-        processes[i].has_started = FALSE;
-    }
-}
-
-// Color scheme for different queue levels
-void get_queue_color(int queue_level, double *r, double *g, double *b) {
-    switch (queue_level) {
-        case 1: *r = 0.2; *g = 0.8; *b = 0.3; break;  // Green - High priority
-        case 2: *r = 0.9; *g = 0.7; *b = 0.2; break;  // Yellow - Medium priority
-        case 3: *r = 0.9; *g = 0.4; *b = 0.4; break;  // Red - Low priority
-        default: *r = 0.5; *g = 0.5; *b = 0.5; break; // Gray
-    }
-}
-
-// Get process color based on name
-void get_process_color(const char *name, double *r, double *g, double *b) {
-    if (strcmp(name, "IDLE") == 0) {
-        *r = 0.85; *g = 0.85; *b = 0.85;
-        return;
-    }
-    
-    int hash = 0;
-    for (int i = 0; name[i] != '\0'; i++) {
-        hash += name[i];
-    }
-    
-    switch (hash % 7) {
-        case 0: *r = 0.3; *g = 0.5; *b = 0.9; break;
-        case 1: *r = 0.9; *g = 0.3; *b = 0.5; break;
-        case 2: *r = 0.5; *g = 0.9; *b = 0.3; break;
-        case 3: *r = 0.9; *g = 0.6; *b = 0.2; break;
-        case 4: *r = 0.6; *g = 0.3; *b = 0.9; break;
-        case 5: *r = 0.3; *g = 0.9; *b = 0.9; break;
-        case 6: *r = 0.9; *g = 0.5; *b = 0.7; break;
-    }
-}
-
-// Drawing callback
-gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
-    int width = gtk_widget_get_allocated_width(widget);
-    int height = gtk_widget_get_allocated_height(widget);
-    
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_paint(cr);
-    
-    // Draw CPU Timeline (Gantt Chart)
-    int timeline_height = 100;
-    int timeline_y = 10;
-    
-    cairo_set_source_rgb(cr, 0, 0, 0);
-    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 14);
-    cairo_move_to(cr, 10, timeline_y + 15);
-    cairo_show_text(cr, "CPU Execution Timeline (Gantt Chart):");
-    
-    // Timeline background
-    cairo_set_source_rgb(cr, 0.95, 0.95, 0.95);
-    cairo_rectangle(cr, 10, timeline_y + 25, width - 20, timeline_height - 30);
-    cairo_fill_preserve(cr);
-    cairo_set_source_rgb(cr, 0.5, 0.5, 0.5);
-    cairo_set_line_width(cr, 2);
-    cairo_stroke(cr);
-    
-    // Draw timeline entries
-    if (timeline_count > 0) {
-        int max_time = current_time > 0 ? current_time : 1;
-        double scale = (width - 40.0) / max_time;
-        
-        for (int i = 0; i < timeline_count; i++) {
-            double x = 20 + timeline[i].start_time * scale;
-            double w = timeline[i].duration * scale;
-            
-            double r, g, b;
-            get_process_color(timeline[i].process_name, &r, &g, &b);
-            
-            cairo_set_source_rgb(cr, r, g, b);
-            cairo_rectangle(cr, x, timeline_y + 30, w, timeline_height - 50);
-            cairo_fill_preserve(cr);
-            cairo_set_source_rgb(cr, 0, 0, 0);
-            cairo_set_line_width(cr, 1);
-            cairo_stroke(cr);
-            
-            // Draw queue level indicator
-            double qr, qg, qb;
-            get_queue_color(timeline[i].queue_level, &qr, &qg, &qb);
-            cairo_set_source_rgb(cr, qr, qg, qb);
-            cairo_rectangle(cr, x, timeline_y + 30 + timeline_height - 50, w, 5);
-            cairo_fill(cr);
-            
-            if (w > 25) {
-                cairo_set_source_rgb(cr, 1, 1, 1);
-                cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-                cairo_set_font_size(cr, 10);
-                
-                cairo_text_extents_t extents;
-                cairo_text_extents(cr, timeline[i].process_name, &extents);
-                cairo_move_to(cr, x + (w - extents.width) / 2, timeline_y + 30 + (timeline_height - 55) / 2 + 4);
-                cairo_show_text(cr, timeline[i].process_name);
-            }
-            
-            // Time markers
-            cairo_set_source_rgb(cr, 0, 0, 0);
-            cairo_set_font_size(cr, 8);
-            char time_str[10];
-            sprintf(time_str, "%d", timeline[i].start_time);
-            cairo_move_to(cr, x - 3, timeline_y + timeline_height - 8);
-            cairo_show_text(cr, time_str);
-        }
-        
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_set_font_size(cr, 8);
-        char time_str[10];
-        sprintf(time_str, "%d", current_time);
-        double final_x = 20 + current_time * scale;
-        cairo_move_to(cr, final_x - 3, timeline_y + timeline_height - 8);
-        cairo_show_text(cr, time_str);
-    }
-    
-    // Draw Priority Queues
-    int queue_section_y = timeline_y + timeline_height + 20;
-    int queue_height = 120;
-    
-    for (int q = 0; q < NUM_QUEUES; q++) {
-        int y = queue_section_y + q * (queue_height + 10);
-        
-        // Queue header
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size(cr, 13);
-        char queue_title[100];
-        sprintf(queue_title, "Queue %d (Priority %d, TQ=%d)", q + 1, q + 1, time_quantum[q]);
-        cairo_move_to(cr, 10, y + 15);
-        cairo_show_text(cr, queue_title);
-        
-        // Queue box with color coding
-        double qr, qg, qb;
-        get_queue_color(q + 1, &qr, &qg, &qb);
-        cairo_set_source_rgba(cr, qr, qg, qb, 0.2);
-        cairo_rectangle(cr, 10, y + 20, width - 20, queue_height - 30);
-        cairo_fill_preserve(cr);
-        cairo_set_source_rgb(cr, qr, qg, qb);
-        cairo_set_line_width(cr, 3);
-        cairo_stroke(cr);
-        
-        // Draw processes in this queue
-        int x_pos = 20;
-        for (int i = 0; i < process_count; i++) {
-            if (processes[i].priority == (q + 1) && processes[i].remaining_time > 0) {
-                // Determine process state color
-                double pr, pg, pb;
-                if (processes[i].arrival_time > current_time) {
-                    pr = 0.9; pg = 0.6; pb = 0.2; // Orange - not arrived
-                } else {
-                    pr = 0.2; pg = 0.8; pb = 0.3; // Green - ready
-                }
-                
-                int box_width = 70;
-                cairo_set_source_rgb(cr, pr, pg, pb);
-                cairo_rectangle(cr, x_pos, y + 30, box_width, queue_height - 50);
-                cairo_fill_preserve(cr);
-                cairo_set_source_rgb(cr, 0, 0, 0);
-                cairo_set_line_width(cr, 1);
-                cairo_stroke(cr);
-                
-                // Process info
-                cairo_set_source_rgb(cr, 0, 0, 0);
-                cairo_set_font_size(cr, 11);
-                cairo_move_to(cr, x_pos + 5, y + 45);
-                cairo_show_text(cr, processes[i].name);
-                
-                cairo_set_font_size(cr, 9);
-                char info[50];
-                sprintf(info, "RT:%d", processes[i].remaining_time);
-                cairo_move_to(cr, x_pos + 5, y + 58);
-                cairo_show_text(cr, info);
-                
-                sprintf(info, "W:%d E:%d", processes[i].time_in_queue, processes[i].time_executing);
-                cairo_move_to(cr, x_pos + 5, y + 70);
-                cairo_show_text(cr, info);
-                
-                x_pos += box_width + 10;
-            }
-        }
-    }
-    
-    // Legend
-    int legend_y = queue_section_y + NUM_QUEUES * (queue_height + 10) + 10;
-    cairo_set_source_rgb(cr, 0, 0, 0);
-    cairo_set_font_size(cr, 10);
-    cairo_move_to(cr, 10, legend_y);
-    cairo_show_text(cr, "Legend - Queue Colors:");
-    
-    for (int i = 0; i < NUM_QUEUES; i++) {
-        double qr, qg, qb;
-        get_queue_color(i + 1, &qr, &qg, &qb);
-        cairo_set_source_rgb(cr, qr, qg, qb);
-        cairo_rectangle(cr, 200 + i * 120, legend_y - 12, 15, 15);
-        cairo_fill(cr);
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        char label[30];
-        sprintf(label, "Priority %d", i + 1);
-        cairo_move_to(cr, 220 + i * 120, legend_y);
-        cairo_show_text(cr, label);
-    }
-    
-    return FALSE;
-}
-
-// Step simulation
-void step_simulation(GtkWidget *widget, gpointer data) {
-    gboolean executed = FALSE;
-    
-    // Update waiting time for all arrived processes
-    for (int i = 0; i < process_count; i++) {
-        if (processes[i].arrival_time <= current_time && processes[i].remaining_time > 0) {
-            processes[i].time_in_queue++;
-            
-            // Check for priority decrease (demotion)
-            if (processes[i].time_in_queue >= decrease_threshold && processes[i].priority < NUM_QUEUES) {
-                processes[i].priority++;
-                processes[i].time_in_queue = 0;
-                processes[i].time_executing = 0;
-                
-                char msg[200];
-                sprintf(msg, "%s demoted to Priority %d (waited too long)", 
-                        processes[i].name, processes[i].priority);
-                gtk_label_set_text(GTK_LABEL(info_label), msg);
-            }
-        }
-    }
-    
-    // Try to execute from highest priority queue first
-    for (int priority = 1; priority <= NUM_QUEUES && !executed; priority++) {
-        for (int i = 0; i < process_count && !executed; i++) {
-            Process *p = &processes[i];
-            
-            if (p->priority == priority && p->remaining_time > 0 && p->arrival_time <= current_time) {
-                int tq = time_quantum[priority - 1];
-                int exec_time = (tq < p->remaining_time) ? tq : p->remaining_time;
-                
-                // Add to timeline
-                if (timeline_count < MAX_TIMELINE) {
-                    strcpy(timeline[timeline_count].process_name, p->name);
-                    timeline[timeline_count].start_time = current_time;
-                    timeline[timeline_count].duration = exec_time;
-                    timeline[timeline_count].queue_level = priority;
-                    timeline_count++;
-                }
-                
-                p->remaining_time -= exec_time;
-                p->time_executing += exec_time;
-                p->time_in_queue = 0; // Reset waiting time
-                current_time += exec_time;
-                
-                if (!p->has_started) {
-                    p->response_time = current_time - p->arrival_time - exec_time;
-                    p->has_started = TRUE;
-                }
-                
-                char info[250];
-                sprintf(info, "Executing %s (Priority %d) for %d units | RT:%d | Exec:%d", 
-                        p->name, p->priority, exec_time, p->remaining_time, p->time_executing);
-                gtk_label_set_text(GTK_LABEL(info_label), info);
-                
-                // Check for aging (promotion)
-                if (p->time_executing >= aging_threshold && p->priority > 1 && p->remaining_time > 0) {
-                    p->priority--;
-                    p->time_executing = 0;
-                    p->time_in_queue = 0;
-                    
-                    char msg[200];
-                    sprintf(msg, "%s promoted to Priority %d (aging)", p->name, p->priority);
-                    gtk_label_set_text(GTK_LABEL(info_label), msg);
-                }
-                
-                if (p->remaining_time == 0) {
-                    p->completion_time = current_time;
-                    p->turnaround_time = p->completion_time - p->arrival_time;
-                    p->waiting_time = p->turnaround_time - p->burst_time;
-                }
-                
-                executed = TRUE;
-            }
-        }
-    }
-    
-    if (!executed) {
-        if (timeline_count < MAX_TIMELINE) {
-            strcpy(timeline[timeline_count].process_name, "IDLE");
-            timeline[timeline_count].start_time = current_time;
-            timeline[timeline_count].duration = 1;
-            timeline[timeline_count].queue_level = 0;
-            timeline_count++;
-        }
-        current_time++;
-        gtk_label_set_text(GTK_LABEL(info_label), "CPU IDLE - No process ready");
-    }
-    
-    char time_str[50];
-    sprintf(time_str, "Current Time: %d", current_time);
-    gtk_label_set_text(GTK_LABEL(time_label), time_str);
-    
-    gtk_widget_queue_draw(drawing_area);
-}
-
-// Reset simulation
-void reset_simulation(GtkWidget *widget, gpointer data) {
-    current_time = 0;
-    timeline_count = 0;
-
-    for (int i = 0; i < process_count; i++) {
-        const char *at_text = gtk_entry_get_text(GTK_ENTRY(process_entries[i][0]));
-        const char *bt_text = gtk_entry_get_text(GTK_ENTRY(process_entries[i][1]));
-        const char *pr_text = gtk_entry_get_text(GTK_ENTRY(process_entries[i][2]));
-
-        if (strlen(at_text) > 0) processes[i].arrival_time = atoi(at_text);
-        if (strlen(bt_text) > 0) processes[i].burst_time = atoi(bt_text);
-        if (strlen(pr_text) > 0) {
-            int pr = atoi(pr_text);
-            if (pr >= 1 && pr <= NUM_QUEUES) processes[i].priority = pr;
-        }
-
-        processes[i].remaining_time = processes[i].burst_time;
-        processes[i].time_in_queue = 0;
-        processes[i].time_executing = 0;
-        processes[i].has_started = FALSE;
-        processes[i].original_priority = processes[i].priority;
-    }
-
-    const char *aging_text = gtk_entry_get_text(GTK_ENTRY(aging_entry));
-    const char *decrease_text = gtk_entry_get_text(GTK_ENTRY(decrease_entry));
-    if (strlen(aging_text) > 0) aging_threshold = atoi(aging_text);
-    if (strlen(decrease_text) > 0) decrease_threshold = atoi(decrease_text);
-
-    // Read TQ values
-    for (int q = 0; q < NUM_QUEUES; q++) {
-        const char *tq_text = gtk_entry_get_text(GTK_ENTRY(tq_entries[q]));
-        if (strlen(tq_text) > 0) {
-            int tq = atoi(tq_text);
-            if (tq > 0) time_quantum[q] = tq;
-        }
-    }
-
-    gtk_label_set_text(GTK_LABEL(info_label), "Simulation reset. Click 'Step' to begin.");
-    gtk_label_set_text(GTK_LABEL(time_label), "Current Time: 0");
-    gtk_widget_queue_draw(drawing_area);
-}
-
-int main(int argc, char *argv[]) {
-    SetDllDirectoryA("dlls");
-    gtk_init(&argc, &argv);
-
-    init_default_processes();
-
-    GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-    gtk_window_set_title(GTK_WINDOW(window), "MLQ with Aging & Priority Decrease");
-    gtk_window_set_default_size(GTK_WINDOW(window), 1100, 750);
-    g_signal_connect(window, "destroy", G_CALLBACK(gtk_main_quit), NULL);
-
-    GtkWidget *main_hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
-    gtk_container_add(GTK_CONTAINER(window), main_hbox);
-
-    GtkWidget *left_panel = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
-    gtk_box_pack_start(GTK_BOX(main_hbox), left_panel, FALSE, FALSE, 5);
-
-    GtkWidget *input_label = gtk_label_new("Process Configuration");
-    PangoFontDescription *font = pango_font_description_from_string("Sans Bold 12");
-    gtk_widget_override_font(input_label, font);
-    pango_font_description_free(font);
-    gtk_box_pack_start(GTK_BOX(left_panel), input_label, FALSE, FALSE, 5);
-
-    GtkWidget *grid = gtk_grid_new();
-    gtk_grid_set_row_spacing(GTK_GRID(grid), 3);
-    gtk_grid_set_column_spacing(GTK_GRID(grid), 5);
-    gtk_box_pack_start(GTK_BOX(left_panel), grid, FALSE, FALSE, 5);
-
-    GtkWidget *headers[4];
-    headers[0] = gtk_label_new("Process");
-    headers[1] = gtk_label_new("AT");
-    headers[2] = gtk_label_new("BT");
-    headers[3] = gtk_label_new("Priority");
-    for (int i = 0; i < 4; i++) gtk_grid_attach(GTK_GRID(grid), headers[i], i, 0, 1, 1);
-
-    for (int i = 0; i < 7; i++) {
-        char label[10];
-        sprintf(label, "P%d", i + 1);
-        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(label), 0, i + 1, 1, 1);
-        for (int j = 0; j < 3; j++) {
-            process_entries[i][j] = gtk_entry_new();
-            gtk_entry_set_width_chars(GTK_ENTRY(process_entries[i][j]), 5);
-            char default_val[10];
-            if (j == 0) sprintf(default_val, "%d", processes[i].arrival_time);
-            else if (j == 1) sprintf(default_val, "%d", processes[i].burst_time);
-            else sprintf(default_val, "%d", processes[i].priority);
-            gtk_entry_set_text(GTK_ENTRY(process_entries[i][j]), default_val);
-            gtk_grid_attach(GTK_GRID(grid), process_entries[i][j], j + 1, i + 1, 1, 1);
-        }
-    }
-
-    GtkWidget *param_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
-    gtk_box_pack_start(GTK_BOX(left_panel), param_box, FALSE, FALSE, 10);
-
-    GtkWidget *aging_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
-    gtk_box_pack_start(GTK_BOX(param_box), aging_box, FALSE, FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(aging_box), gtk_label_new("Aging Time:"), FALSE, FALSE, 0);
-    aging_entry = gtk_entry_new();
-    gtk_entry_set_width_chars(GTK_ENTRY(aging_entry), 5);
-    gtk_entry_set_text(GTK_ENTRY(aging_entry), "5");
-    gtk_box_pack_start(GTK_BOX(aging_box), aging_entry, FALSE, FALSE, 0);
-
-    GtkWidget *decrease_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
-    gtk_box_pack_start(GTK_BOX(param_box), decrease_box, FALSE, FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(decrease_box), gtk_label_new("Decrease Time:"), FALSE, FALSE, 0);
-    decrease_entry = gtk_entry_new();
-    gtk_entry_set_width_chars(GTK_ENTRY(decrease_entry), 5);
-    gtk_entry_set_text(GTK_ENTRY(decrease_entry), "3");
-    gtk_box_pack_start(GTK_BOX(decrease_box), decrease_entry, FALSE, FALSE, 0);
-
-    // TQ controls
-    for (int q = 0; q < NUM_QUEUES; q++) {
-        GtkWidget *tq_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
-        gtk_box_pack_start(GTK_BOX(param_box), tq_box, FALSE, FALSE, 0);
-        char label[30];
-        sprintf(label, "TQ for Queue %d:", q + 1);
-        gtk_box_pack_start(GTK_BOX(tq_box), gtk_label_new(label), FALSE, FALSE, 0);
-        tq_entries[q] = gtk_entry_new();
-        gtk_entry_set_width_chars(GTK_ENTRY(tq_entries[q]), 5);
-        char default_val[10];
-        sprintf(default_val, "%d", time_quantum[q]);
-        gtk_entry_set_text(GTK_ENTRY(tq_entries[q]), default_val);
-        gtk_box_pack_start(GTK_BOX(tq_box), tq_entries[q], FALSE, FALSE, 0);
-    }
-
-    GtkWidget *right_panel = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
-    gtk_box_pack_start(GTK_BOX(main_hbox), right_panel, TRUE, TRUE, 5);
-
-    GtkWidget *title = gtk_label_new("Multi-Level Queue with Aging & Priority Decrease");
-    font = pango_font_description_from_string("Sans Bold 14");
-    gtk_widget_override_font(title, font);
-    pango_font_description_free(font);
-    gtk_box_pack_start(GTK_BOX(right_panel), title, FALSE, FALSE, 5);
-
-    drawing_area = gtk_drawing_area_new();
-    gtk_widget_set_size_request(drawing_area, 800, 600);
-    g_signal_connect(drawing_area, "draw", G_CALLBACK(on_draw), NULL);
-    gtk_box_pack_start(GTK_BOX(right_panel), drawing_area, TRUE, TRUE, 0);
-
-    time_label = gtk_label_new("Current Time: 0");
-    gtk_box_pack_start(GTK_BOX(right_panel), time_label, FALSE, FALSE, 0);
-
-    info_label = gtk_label_new("Click 'Step' to start simulation");
-    gtk_box_pack_start(GTK_BOX(right_panel), info_label, FALSE, FALSE, 0);
-
-    GtkWidget *button_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
-    gtk_box_pack_start(GTK_BOX(right_panel), button_box, FALSE, FALSE, 5);
-
-    GtkWidget *step_btn = gtk_button_new_with_label("Step");
-    g_signal_connect(step_btn, "clicked", G_CALLBACK(step_simulation), NULL);
-    gtk_box_pack_start(GTK_BOX(button_box), step_btn, TRUE, TRUE, 5);
-
-    GtkWidget *reset_btn = gtk_button_new_with_label("Reposition");
-    g_signal_connect(reset_btn, "clicked", G_CALLBACK(reset_simulation), NULL);
-    gtk_box_pack_start(GTK_BOX(button_box), reset_btn, TRUE, TRUE, 5);
-
-    gtk_widget_show_all(window);
-    gtk_main();
-
-    return 0;
-}
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "mlq_engine.h"
+#include "mlq_history.h"
+#include "mlq_metrics.h"
+#include "mlq_policy.h"
+#include "mlq_profile.h"
+#include "mlq_ring.h"
+#include "mlq_zoom.h"
+
+#define MAX_PROCESSES 20
+#define TIMELINE_BUDGET (64 * 1024 * 1024)
+#define HISTORY_BUDGET (256 * 1024 * 1024)
+#define FEED_CAPACITY (1 << 16)     // events in flight between the sim thread and the UI
+#define SNAPSHOT_CARDS 32           // process cards kept per queue row
+#define SNAPSHOT_SCAN 4096          // ordered-queue entries, then pending arrivals, looked at per snapshot
+#define PROFILE_OUT "mlq-profile.folded"    // written at exit by profiling builds
+#define FRAME_MS 16
+
+// The simulation state lives in the engine; the window only views it.
+// While running, the sim thread owns it outright.
+MlqSim sim;
+
+// One process card of the queue panel, copied out of the engine
+typedef struct {
+    int pid;
+    int arrived;
+    int remaining;
+    int waited;
+    int executing;
+    int cpu;
+} ProcessCard;
+
+// What the queue panel shows. The sim thread refreshes it with a trylock,
+// so it never waits on the UI.
+typedef struct {
+    ProcessCard cards[NUM_QUEUES][SNAPSHOT_CARDS];
+    int card_count[NUM_QUEUES];
+    int current_time;
+} QueueSnapshot;
+
+// Engine events travel sim thread -> ring -> frame timer. The UI rebuilds
+// the Gantt history from the DISPATCH and IDLE events into its own
+// timeline, so drawing never touches the engine.
+MlqRing feed;
+MlqTimeline ui_timeline;
+QueueSnapshot snapshot;
+GMutex snapshot_lock;
+GThread *sim_thread;
+int sim_running;            // atomic; cleared to ask the thread to stop
+int sim_exited;             // atomic; set by the thread on its way out
+int sim_rate;               // atomic; steps per second, 0 = as fast as possible
+int run_until;              // the thread stops once the clock reaches this
+
+// Snapshots for stepping back and seeking. Replaying steps the chart and
+// metrics already hold regenerates the same events, so the feed drops
+// them until the run passes explored_steps; the latest one is kept for
+// the status line. Written by whichever thread is stepping.
+MlqHistory history;
+long long explored_steps;
+int explored_time;
+MlqEvent replayed;
+int replayed_valid;
+
+// Fed from the same drained events as the UI timeline, on the UI thread
+MlqMetrics metrics;
+
+GtkWidget *drawing_area;
+GtkWidget *info_label;
+GtkWidget *time_label;
+GtkWidget *stats_label;
+GtkWidget *aging_entry;
+GtkWidget *decrease_entry;
+GtkWidget *tq_entries[NUM_QUEUES];
+GtkWidget *cpus_entry;
+GtkWidget *balance_combo;
+GtkWidget *policy_combo;
+GtkWidget *affinity_check;
+GtkWidget *preempt_check;
+GtkWidget *run_btn;
+GtkWidget *step_btn;
+GtkWidget *back_btn;
+GtkWidget *reset_btn;
+GtkWidget *seek_entry;
+GtkWidget *seek_btn;
+
+GtkWidget *process_entries[MAX_PROCESSES][3];
+
+// Colour and label width per process, computed on first use
+typedef struct {
+    double r, g, b;
+    double name_width;      // at the slice label font
+    int valid;
+} PidStyle;
+
+PidStyle *pid_styles;       // indexed by pid + 1; slot 0 is IDLE
+int pid_style_count;
+
+// Off-screen Gantt lanes. Committed slices never change, so each is
+// painted once; only the open slices are drawn on every expose.
+typedef struct {
+    cairo_surface_t *surface;
+    int width;
+    int lanes;
+    int span;               // ticks across the chart; grows by half when outrun
+    long long drawn;        // committed slices already on the surface
+    int *last_px;           // per lane, the pixel column a sub-pixel slice last filled
+} GanttCache;
+
+GanttCache gantt;
+
+// Zoom and pan over the timeline. Following fits the whole run and draws
+// from the cache; a zoomed window draws from the summary index instead.
+typedef struct {
+    int follow;
+    double start;           // first tick in view
+    double span;            // ticks across the chart
+    double chart_x;         // where the lanes were last drawn, for the mouse handlers
+    double chart_width;
+    int chart_top;
+    int chart_bottom;
+    int dragging;
+    double drag_x;
+    double drag_start;
+} GanttView;
+
+GanttView view = {1};
+MlqZoomIndex zoom;
+
+// Color scheme for different queue levels
+void get_queue_color(int queue_level, double *r, double *g, double *b) {
+    switch (queue_level) {
+        case 1: *r = 0.2; *g = 0.8; *b = 0.3; break;  // Green - High priority
+        case 2: *r = 0.9; *g = 0.7; *b = 0.2; break;  // Yellow - Medium priority
+        case 3: *r = 0.9; *g = 0.4; *b = 0.4; break;  // Red - Low priority
+        default: *r = 0.5; *g = 0.5; *b = 0.5; break; // Gray
+    }
+}
+
+// Get process color based on name
+void get_process_color(const char *name, double *r, double *g, double *b) {
+    if (strcmp(name, "IDLE") == 0) {
+        *r = 0.85; *g = 0.85; *b = 0.85;
+        return;
+    }
+    
+    int hash = 0;
+    for (int i = 0; name[i] != '\0'; i++) {
+        hash += name[i];
+    }
+    
+    switch (hash % 7) {
+        case 0: *r = 0.3; *g = 0.5; *b = 0.9; break;
+        case 1: *r = 0.9; *g = 0.3; *b = 0.5; break;
+        case 2: *r = 0.5; *g = 0.9; *b = 0.3; break;
+        case 3: *r = 0.9; *g = 0.6; *b = 0.2; break;
+        case 4: *r = 0.6; *g = 0.3; *b = 0.9; break;
+        case 5: *r = 0.3; *g = 0.9; *b = 0.9; break;
+        case 6: *r = 0.9; *g = 0.5; *b = 0.7; break;
+    }
+}
+
+// One process card inside a queue row
+void draw_process_box(cairo_t *cr, const ProcessCard *card, int x_pos, int y, int queue_height) {
+    // Determine process state color
+    double pr, pg, pb;
+    if (!card->arrived) {
+        pr = 0.9; pg = 0.6; pb = 0.2; // Orange - not arrived
+    } else {
+        pr = 0.2; pg = 0.8; pb = 0.3; // Green - ready
+    }
+    
+    int box_width = 70;
+    cairo_set_source_rgb(cr, pr, pg, pb);
+    cairo_rectangle(cr, x_pos, y + 30, box_width, queue_height - 50);
+    cairo_fill_preserve(cr);
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_line_width(cr, 1);
+    cairo_stroke(cr);
+    
+    // Process info
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_font_size(cr, 11);
+    cairo_move_to(cr, x_pos + 5, y + 45);
+    char name[16];
+    mlq_process_name(card->pid, name, sizeof(name));
+    cairo_show_text(cr, name);
+    
+    cairo_set_font_size(cr, 9);
+    char info[50];
+    sprintf(info, "RT:%d", card->remaining);
+    cairo_move_to(cr, x_pos + 5, y + 58);
+    cairo_show_text(cr, info);
+    
+    sprintf(info, "W:%d E:%d", card->waited, card->executing);
+    cairo_move_to(cr, x_pos + 5, y + 70);
+    cairo_show_text(cr, info);
+
+    if (sim.cpu_count > 1 && card->cpu >= 0) {
+        sprintf(info, "CPU %d", card->cpu);
+        cairo_move_to(cr, x_pos + 5, y + 82);
+        cairo_show_text(cr, info);
+    }
+}
+
+// End of the furthest lane; each lane's open slice is its latest
+int timeline_end(void) {
+    int end = 0;
+    for (int c = 0; c < ui_timeline.lane_count; c++) {
+        MlqSlice slice;
+        if (mlq_timeline_open_slice(&ui_timeline, c, &slice) == 0 && slice.start_time + slice.duration > end) {
+            end = slice.start_time + slice.duration;
+        }
+    }
+    return end;
+}
+
+void add_card(QueueSnapshot *out, int q, int pid) {
+    if (out->card_count[q] == SNAPSHOT_CARDS) return;
+    const MlqProcess *p = &sim.processes[pid];
+    ProcessCard *card = &out->cards[q][out->card_count[q]++];
+    card->pid = pid;
+    card->arrived = p->arrival_time <= sim.current_time;
+    card->remaining = p->remaining_time;
+    card->waited = mlq_sim_time_in_queue(&sim, pid);
+    card->executing = p->time_executing;
+    card->cpu = p->cpu;
+}
+
+static int cards_full(const QueueSnapshot *out) {
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        if (out->card_count[q] < SNAPSHOT_CARDS) return 0;
+    }
+    return 1;
+}
+
+// Card for an unfinished process at its level; 0 once the scan budget is
+// spent or every row is full
+static int offer_card(QueueSnapshot *out, int pid, int *budget) {
+    const MlqProcess *p = &sim.processes[pid];
+    if (p->remaining_time > 0) add_card(out, p->priority - 1, pid);
+    return --*budget > 0 && !cards_full(out);
+}
+
+// In-order walk of a CPU's run-queue tree; AVL height stays far below 64
+static int offer_tree(QueueSnapshot *out, int root, int *budget) {
+    int stack[64], depth = 0, n = root;
+    while (n >= 0 || depth > 0) {
+        for (; n >= 0; n = sim.processes[n].tree_left) stack[depth++] = n;
+        n = stack[--depth];
+        if (!offer_card(out, n, budget)) return 0;
+        n = sim.processes[n].tree_right;
+    }
+    return 1;
+}
+
+// Run queues CPU by CPU, then processes not yet admitted in arrival order.
+// MLQ rows follow each level's round-robin order; the other policies walk
+// each CPU's tree in key order or its heap from the top, and both they
+// and the pending list stop after SNAPSHOT_SCAN entries, so a frame costs
+// the same however many processes there are. Only the thread that owns
+// the engine may call this.
+void publish_snapshot(int wait) {
+    QueueSnapshot next;
+    next.current_time = sim.current_time;
+    for (int q = 0; q < NUM_QUEUES; q++) next.card_count[q] = 0;
+    int budget = SNAPSHOT_SCAN, more = 1;
+    for (int c = 0; c < sim.cpu_count && more; c++) {
+        const MlqCpu *cpu = &sim.cpus[c];
+        if (sim.policy == &mlq_policy_mlq) {
+            for (int q = 0; q < NUM_QUEUES; q++) {
+                for (int i = cpu->queue_head[q]; i >= 0 && next.card_count[q] < SNAPSHOT_CARDS; i = sim.processes[i].queue_next) {
+                    add_card(&next, q, i);
+                }
+            }
+            continue;
+        }
+        more = offer_tree(&next, cpu->tree_root, &budget);
+        for (int k = 0; k < cpu->heap_count && more; k++) more = offer_card(&next, cpu->heap[k], &budget);
+    }
+    budget = SNAPSHOT_SCAN;
+    more = 1;
+    for (int k = sim.admit_cursor; k < sim.process_count && more; k++) more = offer_card(&next, sim.arrival_order[k], &budget);
+
+    if (wait) g_mutex_lock(&snapshot_lock);
+    else if (!g_mutex_trylock(&snapshot_lock)) return;
+    snapshot = next;
+    g_mutex_unlock(&snapshot_lock);
+}
+
+// Caller has the bold slice font selected
+const PidStyle *pid_style(cairo_t *cr, int pid) {
+    if (pid + 1 >= pid_style_count) {
+        int count = sim.process_count + 1 > pid + 2 ? sim.process_count + 1 : pid + 2;
+        PidStyle *grown = realloc(pid_styles, sizeof(PidStyle) * count);
+        if (!grown) {
+            static PidStyle fallback = {0.5, 0.5, 0.5, 0, 1};
+            return &fallback;
+        }
+        memset(grown + pid_style_count, 0, sizeof(PidStyle) * (count - pid_style_count));
+        pid_styles = grown;
+        pid_style_count = count;
+    }
+
+    PidStyle *st = &pid_styles[pid + 1];
+    if (!st->valid) {
+        char name[16];
+        mlq_process_name(pid, name, sizeof(name));
+        get_process_color(name, &st->r, &st->g, &st->b);
+        cairo_text_extents_t extents;
+        cairo_text_extents(cr, name, &extents);
+        st->name_width = extents.width;
+        st->valid = 1;
+    }
+    return st;
+}
+
+// One Gantt bar in the lane starting at lane_y. A bar under a pixel wide
+// only fills its pixel column, once per lane (last_px), and gets no
+// outline, label or time marker.
+void draw_slice(cairo_t *cr, const MlqSlice *slice, double x0, double scale, int lane_y, int lane_height,
+                int *last_px, int markers_y) {
+    double x = x0 + slice->start_time * scale;
+    double w = slice->duration * scale;
+    const PidStyle *st = pid_style(cr, slice->pid);
+
+    if (w < 1) {
+        int px = (int)x;
+        if (last_px) {
+            if (*last_px == px) return;
+            *last_px = px;
+        }
+        cairo_set_source_rgb(cr, st->r, st->g, st->b);
+        cairo_rectangle(cr, px, lane_y, 1, lane_height);
+        cairo_fill(cr);
+        return;
+    }
+
+    cairo_set_source_rgb(cr, st->r, st->g, st->b);
+    cairo_rectangle(cr, x, lane_y, w, lane_height);
+    cairo_fill_preserve(cr);
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_line_width(cr, 1);
+    cairo_stroke(cr);
+
+    // Draw queue level indicator
+    double qr, qg, qb;
+    get_queue_color(slice->queue_level, &qr, &qg, &qb);
+    cairo_set_source_rgb(cr, qr, qg, qb);
+    cairo_rectangle(cr, x, lane_y + lane_height, w, 5);
+    cairo_fill(cr);
+
+    if (w > 25) {
+        char name[16];
+        mlq_process_name(slice->pid, name, sizeof(name));
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_move_to(cr, x + (w - st->name_width) / 2, lane_y + (lane_height - 5) / 2 + 4);
+        cairo_show_text(cr, name);
+    }
+
+    // Time marker, where there is room for one
+    if (w >= 20) {
+        char time_str[12];
+        sprintf(time_str, "%d", slice->start_time);
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_set_font_size(cr, 8);
+        cairo_move_to(cr, x - 3, markers_y);
+        cairo_show_text(cr, time_str);
+        cairo_set_font_size(cr, 10);
+    }
+}
+
+void gantt_invalidate(void) {
+    if (gantt.surface) cairo_surface_destroy(gantt.surface);
+    gantt.surface = NULL;
+    gantt.drawn = 0;
+}
+
+// Bring the off-screen lanes up to date with the committed timeline,
+// starting over when the size, lane count or time span changes
+void gantt_update(int width, int height, int lanes, int max_time, double x0, int lane_height) {
+    if (gantt.surface && (gantt.width != width || gantt.lanes != lanes || max_time > gantt.span ||
+                          gantt.drawn > ui_timeline.count)) {
+        gantt_invalidate();
+    }
+
+    if (!gantt.surface) {
+        int *last_px = realloc(gantt.last_px, sizeof(int) * lanes);
+        if (!last_px) return;
+        gantt.last_px = last_px;
+        for (int c = 0; c < lanes; c++) gantt.last_px[c] = -1;
+        gantt.surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        gantt.width = width;
+        gantt.lanes = lanes;
+        gantt.span = max_time * 3 / 2 > 16 ? max_time * 3 / 2 : 16;
+        gantt.drawn = 0;
+    }
+
+    double scale = (width - x0 - 20) / gantt.span;
+    cairo_t *cr = cairo_create(gantt.surface);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 10);
+    for (; gantt.drawn < ui_timeline.count; gantt.drawn++) {
+        MlqSlice slice;
+        if (mlq_timeline_get(&ui_timeline, gantt.drawn, &slice) < 0) break;
+        draw_slice(cr, &slice, x0, scale, slice.cpu * (lane_height + 5), lane_height,
+                   &gantt.last_px[slice.cpu], height - 3);
+    }
+    cairo_destroy(cr);
+}
+
+// Where the simulator is; behind the end of the chart after stepping back
+void draw_playhead(cairo_t *cr, double x, int lanes_y, int lanes_height) {
+    cairo_set_source_rgb(cr, 0.8, 0, 0);
+    cairo_set_line_width(cr, 1.5);
+    cairo_move_to(cr, x, lanes_y);
+    cairo_line_to(cr, x, lanes_y + lanes_height);
+    cairo_stroke(cr);
+}
+
+// The whole run: committed slices come from the cache, the still-open ones on top
+void draw_followed(cairo_t *cr, int width, int lanes, int lane_height, int lanes_y, int lanes_height,
+                   double x0, double chart_width, int max_time, int now) {
+    gantt_update(width, lanes_height, lanes, max_time, x0, lane_height);
+    if (gantt.surface) {
+        cairo_set_source_surface(cr, gantt.surface, 0, lanes_y);
+        cairo_paint(cr);
+    }
+
+    double scale = chart_width / (gantt.surface ? gantt.span : max_time);
+    cairo_set_font_size(cr, 10);
+    for (int c = 0; c < lanes; c++) {
+        MlqSlice slice;
+        if (mlq_timeline_open_slice(&ui_timeline, c, &slice) < 0) continue;
+        draw_slice(cr, &slice, x0, scale, lanes_y + c * (lane_height + 5), lane_height,
+                   NULL, lanes_y + lanes_height - 3);
+    }
+
+    if (ui_timeline.count > 0 || max_time > 1) {
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_set_font_size(cr, 8);
+        char time_str[12];
+        sprintf(time_str, "%d", max_time);
+        double final_x = x0 + max_time * scale;
+        cairo_move_to(cr, final_x - 3, lanes_y + lanes_height - 3);
+        cairo_show_text(cr, time_str);
+    }
+    if (now < max_time) draw_playhead(cr, x0 + now * scale, lanes_y, lanes_height);
+}
+
+// Draw [view.start, view.start + view.span) from the summary level whose
+// buckets are about a pixel wide, or from the raw slices once zoomed past
+// the finest level. Each run of equal buckets is a bar in its dominant
+// process's colour, as tall as the lane was busy, over a strip showing the
+// queue-level mix.
+void draw_zoomed(cairo_t *cr, int lanes, int lane_height, int lanes_y, int lanes_height, double x0, double chart_width,
+                 int now) {
+    double scale = chart_width / view.span;
+    double origin = x0 - view.start * scale;
+    int t0 = (int)view.start;
+    int t1 = (int)(view.start + view.span) + 1;
+    int markers_y = lanes_y + lanes_height - 3;
+
+    cairo_save(cr);
+    cairo_rectangle(cr, x0, lanes_y, chart_width, lanes_height);
+    cairo_clip(cr);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 10);
+
+    int level = mlq_zoom_level_for(view.span / chart_width);
+    if (level < 0) {
+        long long first, last;
+        int *last_px = malloc(sizeof(int) * lanes);
+        if (last_px && mlq_zoom_slice_range(&zoom, t0, t1, &first, &last) == 0) {
+            for (int c = 0; c < lanes; c++) last_px[c] = -1;
+            for (long long i = first; i <= last; i++) {
+                MlqSlice slice;
+                if (mlq_timeline_get(&ui_timeline, i, &slice) < 0) break;
+                if (slice.start_time >= t1 || slice.start_time + slice.duration <= t0 || slice.cpu >= lanes) continue;
+                draw_slice(cr, &slice, origin, scale, lanes_y + slice.cpu * (lane_height + 5), lane_height,
+                           &last_px[slice.cpu], markers_y);
+            }
+        }
+        free(last_px);
+    } else {
+        int shift = MLQ_ZOOM_BASE_SHIFT + level;
+        double ticks = (double)(1LL << shift);
+        double w = ticks * scale;
+        for (int c = 0; c < lanes; c++) {
+            int lane_y = lanes_y + c * (lane_height + 5);
+            const MlqZoomRun *runs;
+            int n = mlq_zoom_runs(&zoom, c, level, t0 >> shift, (t1 - 1) >> shift, &runs);
+            for (int r = 0; r < n; r++) {
+                const MlqZoomBucket *bk = &runs[r].bucket;
+                if (bk->busy == 0 || bk->top[0].pid < 0) continue;
+
+                double x = origin + runs[r].first * ticks * scale;
+                double h = lane_height * (bk->busy / ticks);
+                const PidStyle *st = pid_style(cr, bk->top[0].pid);
+                cairo_set_source_rgb(cr, st->r, st->g, st->b);
+                cairo_rectangle(cr, x, lane_y + lane_height - h, runs[r].count * w, h);
+                cairo_fill(cr);
+
+                double mix_x = x;
+                for (int q = 0; q < NUM_QUEUES; q++) {
+                    double part = runs[r].count * w * bk->level_ticks[q] / bk->busy;
+                    double qr, qg, qb;
+                    get_queue_color(q + 1, &qr, &qg, &qb);
+                    cairo_set_source_rgb(cr, qr, qg, qb);
+                    cairo_rectangle(cr, mix_x, lane_y + lane_height, part, 5);
+                    cairo_fill(cr);
+                    mix_x += part;
+                }
+            }
+        }
+    }
+
+    for (int c = 0; c < lanes; c++) {
+        MlqSlice slice;
+        if (mlq_timeline_open_slice(&ui_timeline, c, &slice) < 0) continue;
+        draw_slice(cr, &slice, origin, scale, lanes_y + c * (lane_height + 5), lane_height, NULL, markers_y);
+    }
+
+    // Axis labels every 100px; at that spacing they never collide with the
+    // per-slice markers drawn only for wide slices
+    if (level >= 0) {
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_set_font_size(cr, 8);
+        for (double x = x0; x < x0 + chart_width; x += 100) {
+            char time_str[12];
+            sprintf(time_str, "%d", (int)(view.start + (x - x0) / scale));
+            cairo_move_to(cr, x, markers_y);
+            cairo_show_text(cr, time_str);
+        }
+    }
+    if (now < timeline_end()) draw_playhead(cr, origin + now * scale, lanes_y, lanes_height);
+    cairo_restore(cr);
+}
+
+// Drawing callback
+gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
+    int width = gtk_widget_get_allocated_width(widget);
+    int height = gtk_widget_get_allocated_height(widget);
+    MLQ_PROF_BEGIN(MLQ_ZONE_DRAW);
+    MLQ_PROF_COUNT(MLQ_COUNT_REDRAW, 1);
+    
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_paint(cr);
+    
+    // Draw CPU Timeline (Gantt Chart), one lane per CPU
+    int lanes = sim.cpu_count;
+    int lane_height = lanes == 1 ? 50 : 24;
+    int timeline_height = 50 + lanes * (lane_height + 5);
+    int timeline_y = 10;
+    double x0 = lanes == 1 ? 20 : 60;
+    
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 14);
+    cairo_move_to(cr, 10, timeline_y + 15);
+    cairo_show_text(cr, "CPU Execution Timeline (Gantt Chart):");
+    
+    // Timeline background
+    cairo_set_source_rgb(cr, 0.95, 0.95, 0.95);
+    cairo_rectangle(cr, 10, timeline_y + 25, width - 20, timeline_height - 30);
+    cairo_fill_preserve(cr);
+    cairo_set_source_rgb(cr, 0.5, 0.5, 0.5);
+    cairo_set_line_width(cr, 2);
+    cairo_stroke(cr);
+    
+    // Lanes run to their own CPU's clock; the span covers the furthest one
+    int max_time = timeline_end();
+    if (max_time < 1) max_time = 1;
+
+    if (lanes > 1) {
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_set_font_size(cr, 10);
+        for (int c = 0; c < lanes; c++) {
+            char lane_name[16];
+            sprintf(lane_name, "CPU %d", c);
+            cairo_move_to(cr, 15, timeline_y + 30 + c * (lane_height + 5) + lane_height / 2 + 4);
+            cairo_show_text(cr, lane_name);
+        }
+    }
+
+    int lanes_y = timeline_y + 30;
+    int lanes_height = timeline_height - 30 - 5;
+    double chart_width = width - x0 - 20;
+    view.chart_x = x0;
+    view.chart_width = chart_width;
+    view.chart_top = lanes_y;
+    view.chart_bottom = lanes_y + lanes_height;
+
+    // The index follows the timeline even while not zoomed, so zooming in is immediate
+    mlq_zoom_sync(&zoom, &ui_timeline);
+    QueueSnapshot cards;
+    g_mutex_lock(&snapshot_lock);
+    cards = snapshot;
+    g_mutex_unlock(&snapshot_lock);
+
+    if (view.follow) {
+        draw_followed(cr, width, lanes, lane_height, lanes_y, lanes_height, x0, chart_width, max_time,
+                      cards.current_time);
+    } else {
+        draw_zoomed(cr, lanes, lane_height, lanes_y, lanes_height, x0, chart_width, cards.current_time);
+    }
+    
+    // Draw Priority Queues
+
+    int queue_section_y = timeline_y + timeline_height + 20;
+    int queue_height = 120;
+    
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        int y = queue_section_y + q * (queue_height + 10);
+        
+        // Queue header
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+        cairo_set_font_size(cr, 13);
+        char queue_title[100];
+        if (sim.policy == &mlq_policy_mlq) {
+            sprintf(queue_title, "Queue %d (Priority %d, TQ=%d)", q + 1, q + 1, sim.config.time_quantum[q]);
+        } else {
+            sprintf(queue_title, "Priority %d (%s run queue)", q + 1, sim.policy->name);
+        }
+        cairo_move_to(cr, 10, y + 15);
+        cairo_show_text(cr, queue_title);
+        
+        // Queue box with color coding
+        double qr, qg, qb;
+        get_queue_color(q + 1, &qr, &qg, &qb);
+        cairo_set_source_rgba(cr, qr, qg, qb, 0.2);
+        cairo_rectangle(cr, 10, y + 20, width - 20, queue_height - 30);
+        cairo_fill_preserve(cr);
+        cairo_set_source_rgb(cr, qr, qg, qb);
+        cairo_set_line_width(cr, 3);
+        cairo_stroke(cr);
+        
+        int x_pos = 20;
+        for (int k = 0; k < cards.card_count[q]; k++) {
+            draw_process_box(cr, &cards.cards[q][k], x_pos, y, queue_height);
+            x_pos += 80;
+        }
+    }
+    
+    // Legend
+    int legend_y = queue_section_y + NUM_QUEUES * (queue_height + 10) + 10;
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_font_size(cr, 10);
+    cairo_move_to(cr, 10, legend_y);
+    cairo_show_text(cr, "Legend - Queue Colors:");
+    
+    for (int i = 0; i < NUM_QUEUES; i++) {
+        double qr, qg, qb;
+        get_queue_color(i + 1, &qr, &qg, &qb);
+        cairo_set_source_rgb(cr, qr, qg, qb);
+        cairo_rectangle(cr, 200 + i * 120, legend_y - 12, 15, 15);
+        cairo_fill(cr);
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        char label[30];
+        sprintf(label, "Priority %d", i + 1);
+        cairo_move_to(cr, 220 + i * 120, legend_y);
+        cairo_show_text(cr, label);
+    }
+    
+    MLQ_PROF_END(MLQ_ZONE_DRAW);
+    return FALSE;
+}
+
+int in_chart(double x, double y) {
+    return x >= view.chart_x && x < view.chart_x + view.chart_width && y >= view.chart_top && y < view.chart_bottom;
+}
+
+// Leave follow mode at the span the whole run is drawn with
+void unfollow(void) {
+    if (!view.follow) return;
+    view.follow = 0;
+    view.start = 0;
+    int end = timeline_end();
+    view.span = gantt.surface ? gantt.span : (end > 16 ? end : 16);
+}
+
+void clamp_view(void) {
+    double min_span = view.chart_width / 50;    // one tick at 50px
+    int end = timeline_end();
+    double max_span = 2.0 * (zoom.end_time > end ? zoom.end_time : end) + 16;
+    if (view.span < min_span) view.span = min_span;
+    if (view.span > max_span) view.span = max_span;
+    if (view.start < 0) view.start = 0;
+}
+
+// Wheel zooms around the pointer
+gboolean on_scroll(GtkWidget *widget, GdkEventScroll *event, gpointer data) {
+    if (!in_chart(event->x, event->y)) return FALSE;
+    double factor;
+    if (event->direction == GDK_SCROLL_UP) factor = 0.8;
+    else if (event->direction == GDK_SCROLL_DOWN) factor = 1.25;
+    else if (event->direction == GDK_SCROLL_SMOOTH && event->delta_y != 0) factor = event->delta_y < 0 ? 0.9 : 1.1;
+    else return FALSE;
+
+    unfollow();
+    double frac = (event->x - view.chart_x) / view.chart_width;
+    double anchor = view.start + frac * view.span;
+    view.span *= factor;
+    clamp_view();
+    view.start = anchor - frac * view.span;
+    clamp_view();
+    gtk_widget_queue_draw(drawing_area);
+    return TRUE;
+}
+
+void seek_to(int time);
+
+// Dragging pans; a double click takes the simulator to that tick
+gboolean on_button_press(GtkWidget *widget, GdkEventButton *event, gpointer data) {
+    if (event->button != 1 || !in_chart(event->x, event->y)) return FALSE;
+    unfollow();
+    if (event->type == GDK_2BUTTON_PRESS) {
+        view.dragging = 0;
+        seek_to((int)(view.start + (event->x - view.chart_x) * view.span / view.chart_width));
+        return TRUE;
+    }
+    view.dragging = 1;
+    view.drag_x = event->x;
+    view.drag_start = view.start;
+    return TRUE;
+}
+
+gboolean on_button_release(GtkWidget *widget, GdkEventButton *event, gpointer data) {
+    view.dragging = 0;
+    return FALSE;
+}
+
+gboolean on_motion(GtkWidget *widget, GdkEventMotion *event, gpointer data) {
+    if (!view.dragging) return FALSE;
+    view.start = view.drag_start - (event->x - view.drag_x) * view.span / view.chart_width;
+    clamp_view();
+    gtk_widget_queue_draw(drawing_area);
+    return TRUE;
+}
+
+void fit_timeline(GtkWidget *widget, gpointer data) {
+    view.follow = 1;
+    gtk_widget_queue_draw(drawing_area);
+}
+
+// Turn an engine event into the status line. Process state is only read
+// while the UI thread owns the engine.
+void show_event(const MlqEvent *ev) {
+    char name[16];
+    char msg[250];
+    char where[16] = "";
+    mlq_process_name(ev->pid, name, sizeof(name));
+    if (sim.cpu_count > 1) sprintf(where, "CPU %d: ", ev->cpu);
+
+    switch (ev->kind) {
+        case MLQ_EV_DEMOTE:
+            sprintf(msg, "%s demoted to Priority %d (waited too long)", name, ev->queue_level);
+            break;
+        case MLQ_EV_DISPATCH:
+            if (sim_thread) {
+                sprintf(msg, "%sExecuting %s (Priority %d) for %d units",
+                        where, name, ev->queue_level, ev->duration);
+            } else {
+                const MlqProcess *p = &sim.processes[ev->pid];
+                sprintf(msg, "%sExecuting %s (Priority %d) for %d units | RT:%d | Exec:%d",
+                        where, name, ev->queue_level, ev->duration, p->remaining_time, p->time_executing);
+            }
+            break;
+        case MLQ_EV_PROMOTE:
+            sprintf(msg, "%s promoted to Priority %d (aging)", name, ev->queue_level);
+            break;
+        case MLQ_EV_IDLE:
+            sprintf(msg, "%sCPU IDLE for %d units - No process ready", where, ev->duration);
+            break;
+        case MLQ_EV_MIGRATE:
+            sprintf(msg, "%s migrated to CPU %d (load balancing)", name, ev->cpu);
+            break;
+        case MLQ_EV_PREEMPT:
+            sprintf(msg, "%s%s preempted at %d (higher priority arrival)", where, name, ev->time);
+            break;
+        default:
+            return;
+    }
+    gtk_label_set_text(GTK_LABEL(info_label), msg);
+}
+
+// Engine callback, on whichever thread is stepping. A full ring means the
+// UI is behind; wait for the frame timer to drain it rather than drop
+// slices from the chart.
+void feed_event(const MlqEvent *ev, gpointer data) {
+    if (sim.steps <= explored_steps) {
+        replayed = *ev;
+        replayed_valid = 1;
+        return;
+    }
+    while (mlq_ring_push(&feed, ev) < 0) g_usleep(200);
+}
+
+// Everything up to the current step is in the chart now
+void mark_explored(void) {
+    if (sim.steps <= explored_steps) return;
+    explored_steps = sim.steps;
+    explored_time = sim.current_time;
+}
+
+// Fold queued events into the UI timeline; returns how many were taken
+unsigned drain_feed(void) {
+    MlqEvent batch[1024];
+    MlqEvent last;
+    unsigned total = 0, n;
+    while (total < FEED_CAPACITY && (n = mlq_ring_pop(&feed, batch, 1024)) > 0) {
+        for (unsigned i = 0; i < n; i++) {
+            const MlqEvent *ev = &batch[i];
+            mlq_metrics_event(&metrics, ev);
+            if (ev->kind == MLQ_EV_DISPATCH || ev->kind == MLQ_EV_IDLE) {
+                MLQ_PROF_BEGIN(MLQ_ZONE_TIMELINE);
+                mlq_timeline_append(&ui_timeline, ev->cpu, ev->pid, ev->time, ev->duration, ev->queue_level);
+                MLQ_PROF_END(MLQ_ZONE_TIMELINE);
+            }
+        }
+        last = batch[n - 1];
+        total += n;
+    }
+    if (total > 0) show_event(&last);
+    return total;
+}
+
+void update_time_label(void) {
+    char time_str[50];
+    g_mutex_lock(&snapshot_lock);
+    sprintf(time_str, "Current Time: %d", snapshot.current_time);
+    g_mutex_unlock(&snapshot_lock);
+    gtk_label_set_text(GTK_LABEL(time_label), time_str);
+}
+
+void update_stats_label(void) {
+    static const char *names[NUM_QUEUES + 1] = {"Q1", "Q2", "Q3", "All"};
+    char text[1024];
+    int len = snprintf(text, sizeof(text), "%-4s %6s %6s %6s %6s %6s\n",
+                       "", "resp", "p99", "wait", "p99", "tat");
+    for (int q = 0; q <= NUM_QUEUES; q++) {
+        const MlqSeries *row = metrics.series[q];
+        len += snprintf(text + len, sizeof(text) - len, "%-4s %6.1f %6d %6.1f %6d %6.1f\n", names[q],
+                        row[MLQ_METRIC_RESPONSE].stats.mean,
+                        mlq_series_quantile(&row[MLQ_METRIC_RESPONSE], 0.99),
+                        row[MLQ_METRIC_WAITING].stats.mean,
+                        mlq_series_quantile(&row[MLQ_METRIC_WAITING], 0.99),
+                        row[MLQ_METRIC_TURNAROUND].stats.mean);
+    }
+    snprintf(text + len, sizeof(text) - len,
+             "Utilisation %.1f%%  Done %lld\nSwitches %lld  Promoted %lld  Demoted %lld\nPreempted %lld",
+             100 * mlq_metrics_utilisation(&metrics), metrics.completions,
+             metrics.context_switches, metrics.promotions, metrics.demotions, metrics.preemptions);
+    gtk_label_set_text(GTK_LABEL(stats_label), text);
+}
+
+gpointer sim_thread_main(gpointer data) {
+    gint64 last_publish = g_get_monotonic_time();
+    gint64 pace_start = last_publish;
+    long long paced_steps = 0;
+    int rate = -1;
+    MLQ_PROF_THREAD("sim");
+
+    while (g_atomic_int_get(&sim_running) && !mlq_sim_done(&sim) && sim.current_time < run_until) {
+        gint64 now = g_get_monotonic_time();
+        int wanted = g_atomic_int_get(&sim_rate);
+        if (wanted != rate) {
+            rate = wanted;
+            pace_start = now;
+            paced_steps = 0;
+        }
+        if (rate > 0 && paced_steps >= (now - pace_start) * rate / 1000000) {
+            g_usleep(1000);
+            continue;
+        }
+
+        mlq_history_step(&history, &sim);
+        paced_steps++;
+        if (now - last_publish >= FRAME_MS * 1000) {
+            publish_snapshot(0);
+            last_publish = now;
+        }
+    }
+    publish_snapshot(1);
+    g_atomic_int_set(&sim_exited, 1);
+    return NULL;
+}
+
+void stop_run(void) {
+    if (!sim_thread) return;
+    g_atomic_int_set(&sim_running, 0);
+    // The thread may be waiting on a full ring, so keep draining until it leaves
+    while (!g_atomic_int_get(&sim_exited)) {
+        drain_feed();
+        g_usleep(1000);
+    }
+    g_thread_join(sim_thread);
+    sim_thread = NULL;
+    mark_explored();
+    drain_feed();
+
+    gtk_button_set_label(GTK_BUTTON(run_btn), "Run");
+    gtk_widget_set_sensitive(step_btn, TRUE);
+    gtk_widget_set_sensitive(back_btn, TRUE);
+    gtk_widget_set_sensitive(reset_btn, TRUE);
+    gtk_widget_set_sensitive(seek_btn, TRUE);
+    update_time_label();
+    update_stats_label();
+    gtk_widget_queue_draw(drawing_area);
+}
+
+// Step on the background thread until `until` or the end of the run
+void start_run(int until) {
+    if (mlq_sim_done(&sim)) return;
+
+    run_until = until;
+    g_atomic_int_set(&sim_running, 1);
+    g_atomic_int_set(&sim_exited, 0);
+    sim_thread = g_thread_new("mlq-sim", sim_thread_main, NULL);
+    gtk_button_set_label(GTK_BUTTON(run_btn), "Pause");
+    gtk_widget_set_sensitive(step_btn, FALSE);
+    gtk_widget_set_sensitive(back_btn, FALSE);
+    gtk_widget_set_sensitive(reset_btn, FALSE);
+    gtk_widget_set_sensitive(seek_btn, FALSE);
+}
+
+void toggle_run(GtkWidget *widget, gpointer data) {
+    if (sim_thread) stop_run();
+    else start_run(G_MAXINT);
+}
+
+// Speed slider is log10 of steps per second; the top end is unthrottled
+void speed_changed(GtkWidget *widget, gpointer data) {
+    double v = gtk_range_get_value(GTK_RANGE(widget));
+    g_atomic_int_set(&sim_rate, v >= 6 ? 0 : (int)pow(10, v));
+}
+
+// Frame timer: take what the sim thread produced and repaint once
+gboolean frame_tick(gpointer data) {
+    unsigned drained = drain_feed();
+    if (sim_thread && g_atomic_int_get(&sim_exited)) {
+        stop_run();
+        return G_SOURCE_CONTINUE;
+    }
+    if (drained > 0) update_stats_label();
+    if (drained > 0 || sim_thread) {
+        update_time_label();
+        gtk_widget_queue_draw(drawing_area);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+// Step simulation
+void step_simulation(GtkWidget *widget, gpointer data) {
+    replayed_valid = 0;
+    mlq_history_step(&history, &sim);
+    mark_explored();
+    if (drain_feed() == 0 && replayed_valid) show_event(&replayed);
+    publish_snapshot(1);
+    update_time_label();
+    update_stats_label();
+    gtk_widget_queue_draw(drawing_area);
+}
+
+// After a jump the chart and metrics keep the whole explored run; the
+// queues, clock and playhead show where the simulator now is
+void show_position(int status) {
+    char msg[100];
+    mark_explored();
+    drain_feed();
+    if (status < 0) sprintf(msg, "Can't seek: out of memory or the workload changed; press Reposition.");
+    else sprintf(msg, "At time %d, step %lld of %lld explored", sim.current_time, sim.steps, explored_steps);
+    gtk_label_set_text(GTK_LABEL(info_label), msg);
+    publish_snapshot(1);
+    update_time_label();
+    gtk_widget_queue_draw(drawing_area);
+}
+
+void step_back(GtkWidget *widget, gpointer data) {
+    if (sim.steps == 0) return;
+    show_position(mlq_history_seek(&history, &sim, sim.steps - 1));
+}
+
+// Within the explored run restore the nearest snapshot and replay; past
+// it, jump to the frontier and let the sim thread run up to the target
+void seek_to(int time) {
+    if (sim_thread) return;
+    if (time < 0) time = 0;
+    if (time <= explored_time || mlq_sim_done(&sim)) {
+        show_position(mlq_history_seek_time(&history, &sim, time));
+        return;
+    }
+    if (sim.steps < explored_steps && mlq_history_seek(&history, &sim, explored_steps) < 0) {
+        show_position(-1);
+        return;
+    }
+    start_run(time);
+}
+
+void seek_clicked(GtkWidget *widget, gpointer data) {
+    const char *text = gtk_entry_get_text(GTK_ENTRY(seek_entry));
+    if (strlen(text) > 0) seek_to(atoi(text));
+}
+
+// Reset simulation
+void reset_simulation(GtkWidget *widget, gpointer data) {
+    for (int i = 0; i < sim.process_count; i++) {
+        MlqProcess *p = &sim.processes[i];
+        const char *at_text = gtk_entry_get_text(GTK_ENTRY(process_entries[i][0]));
+        const char *bt_text = gtk_entry_get_text(GTK_ENTRY(process_entries[i][1]));
+        const char *pr_text = gtk_entry_get_text(GTK_ENTRY(process_entries[i][2]));
+
+        if (strlen(at_text) > 0) p->arrival_time = atoi(at_text);
+        if (strlen(bt_text) > 0) p->burst_time = atoi(bt_text);
+        if (strlen(pr_text) > 0) {
+            int pr = atoi(pr_text);
+            if (pr >= 1 && pr <= NUM_QUEUES) p->original_priority = pr;
+        }
+    }
+
+    MlqConfig *cfg = &sim.config;
+    const char *aging_text = gtk_entry_get_text(GTK_ENTRY(aging_entry));
+    const char *decrease_text = gtk_entry_get_text(GTK_ENTRY(decrease_entry));
+    if (strlen(aging_text) > 0) cfg->aging_threshold = atoi(aging_text);
+    if (strlen(decrease_text) > 0) cfg->decrease_threshold = atoi(decrease_text);
+
+    // Read TQ values
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        const char *tq_text = gtk_entry_get_text(GTK_ENTRY(tq_entries[q]));
+        if (strlen(tq_text) > 0) {
+            int tq = atoi(tq_text);
+            if (tq > 0) cfg->time_quantum[q] = tq;
+        }
+    }
+
+    const char *cpus_text = gtk_entry_get_text(GTK_ENTRY(cpus_entry));
+    if (strlen(cpus_text) > 0) {
+        int cpus = atoi(cpus_text);
+        if (cpus >= 1 && cpus <= MLQ_MAX_CPUS) cfg->num_cpus = cpus;
+    }
+    cfg->balance = (MlqBalance)gtk_combo_box_get_active(GTK_COMBO_BOX(balance_combo));
+    cfg->policy = (MlqPolicyKind)gtk_combo_box_get_active(GTK_COMBO_BOX(policy_combo));
+    cfg->pin_affinity = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(affinity_check));
+    cfg->preempt = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(preempt_check));
+
+    drain_feed();
+    gantt_invalidate();
+    mlq_zoom_clear(&zoom);
+    mlq_timeline_clear(&ui_timeline);
+    view.follow = 1;
+    int status = mlq_sim_reset(&sim);
+    if (status == 0) status = mlq_metrics_reset(&metrics);
+    if (status == 0) status = mlq_history_reset(&history, &sim);
+    explored_steps = 0;
+    explored_time = 0;
+    publish_snapshot(1);
+    update_stats_label();
+    if (status < 0) {
+        gtk_label_set_text(GTK_LABEL(info_label), "Out of memory for that many CPUs.");
+        gtk_widget_queue_draw(drawing_area);
+        return;
+    }
+
+    gtk_label_set_text(GTK_LABEL(info_label), "Simulation reset. Click 'Step' to begin.");
+    gtk_label_set_text(GTK_LABEL(time_label), "Current Time: 0");
+    gtk_widget_queue_draw(drawing_area);
+}
+
+void on_quit(GtkWidget *widget, gpointer data) {
+    stop_run();
+    if (mlq_profile_enabled()) {
+        mlq_profile_report(stderr);
+        if (mlq_profile_write_folded(PROFILE_OUT) < 0) perror(PROFILE_OUT);
+    }
+    gtk_main_quit();
+}
+
+int main(int argc, char *argv[]) {
+    SetDllDirectoryA("dlls");
+    gtk_init(&argc, &argv);
+    MLQ_PROF_THREAD("ui");
+
+    MlqConfig cfg;
+    mlq_config_default(&cfg);
+    mlq_sim_init(&sim, &cfg);
+    mlq_sim_add_default_processes(&sim);
+    sim.on_event = feed_event;
+    mlq_timeline_init(&ui_timeline, TIMELINE_BUDGET, NULL);
+    mlq_ring_init(&feed, FEED_CAPACITY);
+    g_mutex_init(&snapshot_lock);
+    publish_snapshot(1);
+    mlq_zoom_init(&zoom);
+    mlq_metrics_init(&metrics, &sim);
+    mlq_history_init(&history, HISTORY_BUDGET);
+    mlq_history_reset(&history, &sim);
+
+    GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window), "MLQ with Aging & Priority Decrease");
+    gtk_window_set_default_size(GTK_WINDOW(window), 1100, 750);
+    g_signal_connect(window, "destroy", G_CALLBACK(on_quit), NULL);
+
+    GtkWidget *main_hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_container_add(GTK_CONTAINER(window), main_hbox);
+
+    GtkWidget *left_panel = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_box_pack_start(GTK_BOX(main_hbox), left_panel, FALSE, FALSE, 5);
+
+    GtkWidget *input_label = gtk_label_new("Process Configuration");
+    PangoFontDescription *font = pango_font_description_from_string("Sans Bold 12");
+    gtk_widget_override_font(input_label, font);
+    pango_font_description_free(font);
+    gtk_box_pack_start(GTK_BOX(left_panel), input_label, FALSE, FALSE, 5);
+
+    GtkWidget *grid = gtk_grid_new();
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 3);
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 5);
+    gtk_box_pack_start(GTK_BOX(left_panel), grid, FALSE, FALSE, 5);
+
+    GtkWidget *headers[4];
+    headers[0] = gtk_label_new("Process");
+    headers[1] = gtk_label_new("AT");
+    headers[2] = gtk_label_new("BT");
+    headers[3] = gtk_label_new("Priority");
+    for (int i = 0; i < 4; i++) gtk_grid_attach(GTK_GRID(grid), headers[i], i, 0, 1, 1);
+
+    for (int i = 0; i < 7; i++) {
+        char label[10];
+        sprintf(label, "P%d", i + 1);
+        gtk_grid_attach(GTK_GRID(grid), gtk_label_new(label), 0, i + 1, 1, 1);
+        for (int j = 0; j < 3; j++) {
+            process_entries[i][j] = gtk_entry_new();
+            gtk_entry_set_width_chars(GTK_ENTRY(process_entries[i][j]), 5);
+            char default_val[10];
+            if (j == 0) sprintf(default_val, "%d", sim.processes[i].arrival_time);
+            else if (j == 1) sprintf(default_val, "%d", sim.processes[i].burst_time);
+            else sprintf(default_val, "%d", sim.processes[i].priority);
+            gtk_entry_set_text(GTK_ENTRY(process_entries[i][j]), default_val);
+            gtk_grid_attach(GTK_GRID(grid), process_entries[i][j], j + 1, i + 1, 1, 1);
+        }
+    }
+
+    GtkWidget *param_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_box_pack_start(GTK_BOX(left_panel), param_box, FALSE, FALSE, 10);
+
+    GtkWidget *policy_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(param_box), policy_box, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(policy_box), gtk_label_new("Policy:"), FALSE, FALSE, 0);
+    policy_combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(policy_combo), "MLQ (aging)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(policy_combo), "CFS (fair share)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(policy_combo), "EDF (deadline)");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(policy_combo), "Stride");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(policy_combo), sim.config.policy);
+    gtk_box_pack_start(GTK_BOX(policy_box), policy_combo, FALSE, FALSE, 0);
+
+    GtkWidget *aging_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(param_box), aging_box, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(aging_box), gtk_label_new("Aging Time:"), FALSE, FALSE, 0);
+    aging_entry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(aging_entry), 5);
+    gtk_entry_set_text(GTK_ENTRY(aging_entry), "5");
+    gtk_box_pack_start(GTK_BOX(aging_box), aging_entry, FALSE, FALSE, 0);
+
+    GtkWidget *decrease_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(param_box), decrease_box, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(decrease_box), gtk_label_new("Decrease Time:"), FALSE, FALSE, 0);
+    decrease_entry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(decrease_entry), 5);
+    gtk_entry_set_text(GTK_ENTRY(decrease_entry), "3");
+    gtk_box_pack_start(GTK_BOX(decrease_box), decrease_entry, FALSE, FALSE, 0);
+
+    // TQ controls
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        GtkWidget *tq_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+        gtk_box_pack_start(GTK_BOX(param_box), tq_box, FALSE, FALSE, 0);
+        char label[30];
+        sprintf(label, "TQ for Queue %d:", q + 1);
+        gtk_box_pack_start(GTK_BOX(tq_box), gtk_label_new(label), FALSE, FALSE, 0);
+        tq_entries[q] = gtk_entry_new();
+        gtk_entry_set_width_chars(GTK_ENTRY(tq_entries[q]), 5);
+        char default_val[10];
+        sprintf(default_val, "%d", sim.config.time_quantum[q]);
+        gtk_entry_set_text(GTK_ENTRY(tq_entries[q]), default_val);
+        gtk_box_pack_start(GTK_BOX(tq_box), tq_entries[q], FALSE, FALSE, 0);
+    }
+
+    // CPU controls
+    GtkWidget *cpus_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(param_box), cpus_box, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(cpus_box), gtk_label_new("CPUs:"), FALSE, FALSE, 0);
+    cpus_entry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(cpus_entry), 5);
+    gtk_entry_set_text(GTK_ENTRY(cpus_entry), "1");
+    gtk_box_pack_start(GTK_BOX(cpus_box), cpus_entry, FALSE, FALSE, 0);
+
+    GtkWidget *balance_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(param_box), balance_box, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(balance_box), gtk_label_new("Balancing:"), FALSE, FALSE, 0);
+    balance_combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(balance_combo), "None");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(balance_combo), "Push");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(balance_combo), "Steal");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(balance_combo), "Push + Steal");
+    gtk_combo_box_set_active(GTK_COMBO_BOX(balance_combo), sim.config.balance);
+    gtk_box_pack_start(GTK_BOX(balance_box), balance_combo, FALSE, FALSE, 0);
+
+    affinity_check = gtk_check_button_new_with_label("Pin to CPU (affinity)");
+    gtk_box_pack_start(GTK_BOX(param_box), affinity_check, FALSE, FALSE, 0);
+    preempt_check = gtk_check_button_new_with_label("Preempt on arrival / promotion");
+    gtk_box_pack_start(GTK_BOX(param_box), preempt_check, FALSE, FALSE, 0);
+
+    // Running statistics
+    GtkWidget *stats_title = gtk_label_new("Statistics");
+    font = pango_font_description_from_string("Sans Bold 12");
+    gtk_widget_override_font(stats_title, font);
+    pango_font_description_free(font);
+    gtk_box_pack_start(GTK_BOX(left_panel), stats_title, FALSE, FALSE, 5);
+
+    stats_label = gtk_label_new("");
+    font = pango_font_description_from_string("Monospace 9");
+    gtk_widget_override_font(stats_label, font);
+    pango_font_description_free(font);
+    gtk_label_set_xalign(GTK_LABEL(stats_label), 0);
+    gtk_box_pack_start(GTK_BOX(left_panel), stats_label, FALSE, FALSE, 0);
+    update_stats_label();
+
+    GtkWidget *right_panel = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    gtk_box_pack_start(GTK_BOX(main_hbox), right_panel, TRUE, TRUE, 5);
+
+    GtkWidget *title = gtk_label_new("Multi-Level Queue with Aging & Priority Decrease");
+    font = pango_font_description_from_string("Sans Bold 14");
+    gtk_widget_override_font(title, font);
+    pango_font_description_free(font);
+    gtk_box_pack_start(GTK_BOX(right_panel), title, FALSE, FALSE, 5);
+
+    drawing_area = gtk_drawing_area_new();
+    gtk_widget_set_size_request(drawing_area, 800, 600);
+    g_signal_connect(drawing_area, "draw", G_CALLBACK(on_draw), NULL);
+    gtk_widget_add_events(drawing_area, GDK_SCROLL_MASK | GDK_BUTTON_PRESS_MASK |
+                                        GDK_BUTTON_RELEASE_MASK | GDK_BUTTON1_MOTION_MASK);
+    g_signal_connect(drawing_area, "scroll-event", G_CALLBACK(on_scroll), NULL);
+    g_signal_connect(drawing_area, "button-press-event", G_CALLBACK(on_button_press), NULL);
+    g_signal_connect(drawing_area, "button-release-event", G_CALLBACK(on_button_release), NULL);
+    g_signal_connect(drawing_area, "motion-notify-event", G_CALLBACK(on_motion), NULL);
+    gtk_box_pack_start(GTK_BOX(right_panel), drawing_area, TRUE, TRUE, 0);
+
+    time_label = gtk_label_new("Current Time: 0");
+    gtk_box_pack_start(GTK_BOX(right_panel), time_label, FALSE, FALSE, 0);
+
+    info_label = gtk_label_new("Click 'Step' to start simulation");
+    gtk_box_pack_start(GTK_BOX(right_panel), info_label, FALSE, FALSE, 0);
+
+    GtkWidget *button_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
+    gtk_box_pack_start(GTK_BOX(right_panel), button_box, FALSE, FALSE, 5);
+
+    step_btn = gtk_button_new_with_label("Step");
+    g_signal_connect(step_btn, "clicked", G_CALLBACK(step_simulation), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), step_btn, TRUE, TRUE, 5);
+
+    back_btn = gtk_button_new_with_label("Step Back");
+    g_signal_connect(back_btn, "clicked", G_CALLBACK(step_back), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), back_btn, TRUE, TRUE, 5);
+
+    reset_btn = gtk_button_new_with_label("Reposition");
+    g_signal_connect(reset_btn, "clicked", G_CALLBACK(reset_simulation), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), reset_btn, TRUE, TRUE, 5);
+
+    run_btn = gtk_button_new_with_label("Run");
+    g_signal_connect(run_btn, "clicked", G_CALLBACK(toggle_run), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), run_btn, TRUE, TRUE, 5);
+
+    // Speed: 10^v steps per second, unthrottled at the top
+    gtk_box_pack_start(GTK_BOX(button_box), gtk_label_new("Speed:"), FALSE, FALSE, 0);
+    GtkWidget *speed_scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 6, 0.1);
+    gtk_scale_set_draw_value(GTK_SCALE(speed_scale), FALSE);
+    gtk_widget_set_size_request(speed_scale, 150, -1);
+    gtk_range_set_value(GTK_RANGE(speed_scale), 1);
+    speed_changed(speed_scale, NULL);
+    g_signal_connect(speed_scale, "value-changed", G_CALLBACK(speed_changed), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), speed_scale, FALSE, FALSE, 5);
+
+    GtkWidget *fit_btn = gtk_button_new_with_label("Fit Timeline");
+    g_signal_connect(fit_btn, "clicked", G_CALLBACK(fit_timeline), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), fit_btn, TRUE, TRUE, 5);
+
+    // Go to a tick; double-clicking the chart does the same
+    seek_entry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(seek_entry), 10);
+    gtk_entry_set_placeholder_text(GTK_ENTRY(seek_entry), "time");
+    g_signal_connect(seek_entry, "activate", G_CALLBACK(seek_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), seek_entry, FALSE, FALSE, 0);
+    seek_btn = gtk_button_new_with_label("Go");
+    g_signal_connect(seek_btn, "clicked", G_CALLBACK(seek_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(button_box), seek_btn, FALSE, FALSE, 5);
+
+    g_timeout_add(FRAME_MS, frame_tick, NULL);
+
+    gtk_widget_show_all(window);
+    gtk_main();
+
+    gantt_invalidate();
+    free(gantt.last_px);
+    mlq_zoom_free(&zoom);
+    mlq_timeline_free(&ui_timeline);
+    mlq_ring_free(&feed);
+    mlq_history_free(&history);
+    g_mutex_clear(&snapshot_lock);
+    free(pid_styles);
+    mlq_sim_free(&sim);
+    return 0;
+}
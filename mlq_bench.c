@@ -0,0 +1,379 @@
+// Scheduler core benchmark: times the dispatch/aging path over a grid of
+// workloads and compares against a saved baseline
+#define _GNU_SOURCE               // the glibc allocator entry points
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// On glibc every heap allocation in the process goes through the
+// definitions below, so a run reports what the engine, its policies and
+// the timeline allocated, however they allocate. Elsewhere the counts are
+// -1 and left out of baseline comparisons.
+static long long alloc_count;
+static long long alloc_bytes;
+
+#ifdef __GLIBC__
+#define ALLOC_COUNTED 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+
+static void count_alloc(size_t size) {
+    alloc_count++;
+    alloc_bytes += (long long)size;
+}
+
+void *malloc(size_t size) {
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    count_alloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    count_alloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1))) return EINVAL;
+    void *p = memalign(alignment, size);
+    if (!p) return ENOMEM;
+    *ptr = p;
+    return 0;
+}
+#else
+#define ALLOC_COUNTED 0
+#endif
+
+#include "mlq_engine.h"
+#include "mlq_profile.h"
+#include "mlq_sweep.h"
+#include "mlq_workload.h"
+
+#define MAX_CASES 64
+#define MIN_CASE_SECONDS 0.2        // small workloads are re-run until this much time is measured
+
+typedef struct {
+    char name[64];
+    int processes;
+    int levels;                     // priority levels the workload uses
+    int tq[NUM_QUEUES];
+    double mean_gap;
+} BenchCase;
+
+typedef struct {
+    char name[64];
+    long long steps;                // decisions per run
+    int runs;
+    double ns_per_step;
+    double steps_per_sec;
+    long long allocs;               // inside the first mlq_sim_run after a reset
+    long long alloc_bytes;
+    long peak_rss_kb;               // of the case's own process (the whole suite on Windows)
+} BenchResult;
+
+static const int default_tq[NUM_QUEUES] = {2, 4, 8};
+
+static long peak_rss_kb(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return (long)(pmc.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) < 0) return 0;
+    return usage.ru_maxrss;
+#endif
+}
+
+static void case_init(BenchCase *bc, int processes, int levels, const int *tq, double mean_gap) {
+    bc->processes = processes;
+    bc->levels = levels;
+    memcpy(bc->tq, tq, sizeof(bc->tq));
+    bc->mean_gap = mean_gap;
+    snprintf(bc->name, sizeof(bc->name), "n=%d levels=%d tq=%d:%d:%d gap=%g",
+             processes, levels, tq[0], tq[1], tq[2], mean_gap);
+}
+
+// Process count scaling with everything else at the defaults, then each
+// of levels, quanta and arrival density varied alone at `mid` processes
+static int build_cases(BenchCase *cases, int max_processes, int mid) {
+    static const int tq_sets[][NUM_QUEUES] = {{1, 2, 4}, {8, 16, 32}};
+    static const double gaps[] = {0.5, 32};
+    int count = 0;
+    for (long long n = 10; n <= max_processes; n *= 10) {
+        case_init(&cases[count++], (int)n, NUM_QUEUES, default_tq, 4);
+    }
+    if (mid > max_processes) mid = max_processes;
+    for (int levels = 1; levels < NUM_QUEUES; levels++) {
+        case_init(&cases[count++], mid, levels, default_tq, 4);
+    }
+    for (int t = 0; t < 2; t++) case_init(&cases[count++], mid, NUM_QUEUES, tq_sets[t], 4);
+    for (int g = 0; g < 2; g++) case_init(&cases[count++], mid, NUM_QUEUES, default_tq, gaps[g]);
+    return count;
+}
+
+static int run_case(const BenchCase *bc, int cpus, BenchResult *out) {
+    MlqGenParams gen;
+    mlq_gen_params_default(&gen);
+    gen.count = bc->processes;
+    gen.mean_interarrival = bc->mean_gap;
+    for (int q = 0; q < NUM_QUEUES; q++) gen.priority_mix[q] = q < bc->levels ? 1 : 0;
+
+    MlqConfig cfg;
+    mlq_config_default(&cfg);
+    memcpy(cfg.time_quantum, bc->tq, sizeof(cfg.time_quantum));
+    cfg.num_cpus = cpus;
+
+    MlqWorkload wl;
+    mlq_workload_init(&wl);
+    MlqSim sim;
+    if (mlq_sim_init(&sim, &cfg) < 0) return -1;
+    if (mlq_workload_generate(&wl, &gen) < 0 || mlq_sim_load_workload(&sim, &wl) < 0) {
+        mlq_workload_free(&wl);
+        mlq_sim_free(&sim);
+        return -1;
+    }
+    mlq_workload_free(&wl);
+
+    memset(out, 0, sizeof(*out));
+    strcpy(out->name, bc->name);
+
+    // The untimed first run grows the run queues and heaps to size; its
+    // allocations are exact and don't depend on how many runs follow
+    if (mlq_sim_reset(&sim) < 0) {
+        mlq_sim_free(&sim);
+        return -1;
+    }
+    long long count_before = alloc_count, bytes_before = alloc_bytes;
+    mlq_sim_run(&sim);
+    out->allocs = ALLOC_COUNTED ? alloc_count - count_before : -1;
+    out->alloc_bytes = ALLOC_COUNTED ? alloc_bytes - bytes_before : -1;
+
+    double elapsed = 0;
+    long long total_steps = 0;
+    do {
+        if (mlq_sim_reset(&sim) < 0) {
+            mlq_sim_free(&sim);
+            return -1;
+        }
+        double start = mlq_wall_seconds();
+        mlq_sim_run(&sim);
+        elapsed += mlq_wall_seconds() - start;
+        total_steps += sim.steps;
+        out->runs++;
+    } while (elapsed < MIN_CASE_SECONDS);
+
+    out->steps = sim.steps;
+    out->ns_per_step = total_steps > 0 ? elapsed * 1e9 / total_steps : 0;
+    out->steps_per_sec = elapsed > 0 ? total_steps / elapsed : 0;
+    out->peak_rss_kb = peak_rss_kb();
+    mlq_sim_free(&sim);
+    return 0;
+}
+
+// Runs the case in a child process so its peak RSS is its own rather than
+// the high-water mark of every case before it. Profiled builds stay in
+// process so the zones reach the final report.
+static int run_case_isolated(const BenchCase *bc, int cpus, BenchResult *out) {
+#ifdef _WIN32
+    return run_case(bc, cpus, out);
+#else
+    int fds[2];
+    if (mlq_profile_enabled() || pipe(fds) < 0) return run_case(bc, cpus, out);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return run_case(bc, cpus, out);
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        int ok = run_case(bc, cpus, out) == 0 && write(fds[1], out, sizeof(*out)) == (ssize_t)sizeof(*out);
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], out, sizeof(*out));
+    close(fds[0]);
+    int status;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return -1;
+    return got == (ssize_t)sizeof(*out) ? 0 : -1;
+#endif
+}
+
+static const char *csv_header = "case,steps,runs,ns_per_step,steps_per_sec,allocs,alloc_bytes,peak_rss_kb";
+
+static int save_baseline(const char *path, const BenchResult *results, int count) {
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return -1;
+    }
+    fprintf(out, "%s\n", csv_header);
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(out, "%s,%lld,%d,%.3f,%.0f,%lld,%lld,%ld\n", r->name, r->steps, r->runs,
+                r->ns_per_step, r->steps_per_sec, r->allocs, r->alloc_bytes, r->peak_rss_kb);
+    }
+    fclose(out);
+    return 0;
+}
+
+static int load_baseline(const char *path, BenchResult *results, int max) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+    char line[256];
+    int count = 0;
+    while (count < max && fgets(line, sizeof(line), in)) {
+        BenchResult *r = &results[count];
+        memset(r, 0, sizeof(*r));
+        char *comma = strchr(line, ',');
+        if (!comma || strncmp(line, "case,", 5) == 0) continue;
+        size_t len = (size_t)(comma - line);
+        if (len >= sizeof(r->name)) continue;
+        memcpy(r->name, line, len);
+        if (sscanf(comma + 1, "%lld,%d,%lf,%lf,%lld,%lld,%ld", &r->steps, &r->runs, &r->ns_per_step,
+                   &r->steps_per_sec, &r->allocs, &r->alloc_bytes, &r->peak_rss_kb) == 7) {
+            count++;
+        }
+    }
+    fclose(in);
+    return count;
+}
+
+// A case regresses when a decision got slower by more than the tolerance,
+// the run allocates more, or the schedule itself changed length
+static int compare(const BenchResult *r, const BenchResult *base, int base_count, double tolerance) {
+    for (int i = 0; i < base_count; i++) {
+        if (strcmp(base[i].name, r->name) != 0) continue;
+        double change = base[i].ns_per_step > 0 ? r->ns_per_step / base[i].ns_per_step - 1 : 0;
+        int slower = change > tolerance;
+        int allocs = r->allocs >= 0 && base[i].allocs >= 0 && r->allocs > base[i].allocs;
+        int steps = r->steps != base[i].steps;
+        printf("  %+6.1f%%%s%s%s\n", 100 * change, slower ? "  REGRESSION" : "",
+               allocs ? "  MORE ALLOCS" : "", steps ? "  STEPS CHANGED" : "");
+        return slower || allocs || steps;
+    }
+    printf("  (not in baseline)\n");
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --max N          largest process count (default 1000000, up to 10000000)\n"
+            "  --mid N          process count for the level/quantum/density cases (default 100000)\n"
+            "  --cpus N         simulated CPUs (default 1)\n"
+            "  --save FILE      write the results as a baseline CSV\n"
+            "  --baseline FILE  compare against a saved baseline; exit 1 on regression\n"
+            "  --tolerance PCT  allowed slowdown per decision before flagging (default 10)\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    int max_processes = 1000000;
+    int mid = 100000;
+    int cpus = 1;
+    double tolerance = 0.10;
+    const char *save_path = NULL;
+    const char *baseline_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--max") == 0 && val) {
+            max_processes = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--mid") == 0 && val) {
+            mid = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--cpus") == 0 && val) {
+            cpus = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--save") == 0 && val) {
+            save_path = val;
+            i++;
+        } else if (strcmp(arg, "--baseline") == 0 && val) {
+            baseline_path = val;
+            i++;
+        } else if (strcmp(arg, "--tolerance") == 0 && val) {
+            tolerance = atof(val) / 100;
+            i++;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (max_processes < 10 || max_processes > 10000000 || mid < 1 || cpus < 1 || cpus > MLQ_MAX_CPUS) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    BenchResult *baseline = NULL;
+    int baseline_count = 0;
+    if (baseline_path) {
+        baseline = malloc(sizeof(BenchResult) * MAX_CASES);
+        if (!baseline || (baseline_count = load_baseline(baseline_path, baseline, MAX_CASES)) < 0) {
+            free(baseline);
+            return 1;
+        }
+    }
+
+    BenchCase cases[MAX_CASES];
+    BenchResult results[MAX_CASES];
+    int count = build_cases(cases, max_processes, mid);
+    int regressions = 0;
+
+    printf("%-40s %10s %10s %12s %8s %10s\n", "case", "steps", "ns/step", "steps/sec", "allocs", "rss KB");
+    for (int i = 0; i < count; i++) {
+        if (run_case_isolated(&cases[i], cpus, &results[i]) < 0) {
+            fprintf(stderr, "%s: out of memory\n", cases[i].name);
+            free(baseline);
+            return 1;
+        }
+        const BenchResult *r = &results[i];
+        printf("%-40s %10lld %10.1f %12.0f %8lld %10ld\n", r->name, r->steps, r->ns_per_step,
+               r->steps_per_sec, r->allocs, r->peak_rss_kb);
+        if (baseline) regressions += compare(r, baseline, baseline_count, tolerance);
+        fflush(stdout);
+    }
+    free(baseline);
+    mlq_profile_report(stderr);
+
+    if (save_path && save_baseline(save_path, results, count) < 0) return 1;
+    if (baseline_path) {
+        printf("%d of %d cases regressed\n", regressions, count);
+        if (regressions > 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,698 @@
+// Headless batch runner: runs a workload to completion and prints metrics
+#include "mlq_engine.h"
+#include "mlq_import.h"
+#include "mlq_metrics.h"
+#include "mlq_policy.h"
+#include "mlq_profile.h"
+#include "mlq_shm.h"
+#include "mlq_sweep.h"
+#include "mlq_trace.h"
+#include "mlq_workload.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options] [workload]\n"
+            "  workload: CSV <arrival>,<burst>,<priority> or MLQW binary (default: built-in 7 processes)\n"
+            "  --generate N     synthetic workload of N jobs instead of a file\n"
+            "  --seed S         generator seed (default 1)\n"
+            "  --mean-gap X     mean ticks between arrivals (default 4)\n"
+            "  --burst-alpha A  Pareto shape of burst lengths (default 1.5)\n"
+            "  --burst-max N    longest burst (default 1000)\n"
+            "  --mix A,B,C      relative weight of each priority level\n"
+            "  --import FILE    replay `perf sched script` output or a --sample-proc capture (- for stdin)\n"
+            "  --import-tick US microseconds per tick for --import (default 1000)\n"
+            "  --sample-proc FILE    record this machine's threads from /proc for --import, then exit\n"
+            "  --sample-interval MS  /proc sampling interval (default 10)\n"
+            "  --sample-seconds S    how long to sample (default 10)\n"
+            "  --save-workload FILE  write the workload as MLQW binary\n"
+            "  --policy NAME    mlq, cfs, edf or stride (default mlq)\n"
+            "  --aging N        aging (promotion) threshold\n"
+            "  --decrease N     priority decrease (demotion) threshold\n"
+            "  --tq A,B,C       time quantum per queue\n"
+            "  --cpus N         simulated CPUs, each with its own run queues (default 1)\n"
+            "  --balance MODE   none, push, steal or both (default steal)\n"
+            "  --affinity       pin process i to CPU i %% N; disables balancing\n"
+            "  --preempt        cut a slice when a higher priority arrives or the runner is promoted\n"
+            "  --repeat N       run the workload N times (for throughput)\n"
+            "  --quiet          don't print the per-process table\n"
+            "  --timeline FILE  record the full Gantt history to FILE\n"
+            "  --timeline-budget MB  resident timeline memory before spilling (default 64)\n"
+            "  --metrics FORMAT streaming latency histograms per queue level as json or csv\n"
+            "  --metrics-out FILE    write the metrics to FILE (default stdout)\n"
+            "  --trace FORMAT   export the first run as a json (Chrome) or perfetto trace\n"
+            "  --trace-out FILE write the trace to FILE, gzipped if it ends in .gz\n"
+            "                   (default mlq-trace.json or mlq-trace.pftrace)\n"
+            "  --shm NAME       publish live state to POSIX shared memory NAME (e.g. %s)\n"
+            "  --profile        print where the simulator's time went (build with -DMLQ_PROFILE)\n"
+            "  --profile-out FILE    also write collapsed stacks for flamegraph.pl\n"
+            "  --sweep-cpus R, --sweep-aging R, --sweep-decrease R, --sweep-tq1 R .. --sweep-tq%d R\n"
+            "                   run the grid of ranges R = lo:hi[:step] in parallel\n"
+            "  --threads N      sweep worker threads (default: one per CPU)\n"
+            "  --sweep-out FILE write the sweep table as CSV (default stdout)\n"
+            "  --check          also run the per-step counter reference and compare\n"
+            "  --compare-preempt    also run without and with --preempt and compare latencies\n",
+            prog, MLQ_SHM_DEFAULT_NAME, NUM_QUEUES);
+}
+
+static int parse_mix(const char *arg, double *mix) {
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        char *end;
+        mix[q] = strtod(arg, &end);
+        if (end == arg || mix[q] < 0) return -1;
+        if (q < NUM_QUEUES - 1) {
+            if (*end != ',') return -1;
+            arg = end + 1;
+        } else if (*end != '\0') {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int parse_balance(const char *arg, MlqBalance *balance) {
+    static const char *names[] = {"none", "push", "steal", "both"};
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(arg, names[i]) == 0) {
+            *balance = (MlqBalance)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_tq(const char *arg, int *tq) {
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        char *end;
+        long v = strtol(arg, &end, 10);
+        if (end == arg || v <= 0) return -1;
+        tq[q] = (int)v;
+        if (q < NUM_QUEUES - 1) {
+            if (*end != ',') return -1;
+            arg = end + 1;
+        } else if (*end != '\0') {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Differential check: lazy deadline aging must match the counter scan exactly
+static int check_against_reference(const MlqSim *sim) {
+    MlqConfig cfg = sim->config;
+    cfg.eager_aging = 1;
+    cfg.record_timeline = 0;
+
+    MlqSim ref;
+    if (mlq_sim_init(&ref, &cfg) < 0) return -1;
+    for (int i = 0; i < sim->process_count; i++) {
+        const MlqProcess *p = &sim->processes[i];
+        if (mlq_sim_add_process(&ref, p->arrival_time, p->burst_time, p->original_priority) < 0) {
+            mlq_sim_free(&ref);
+            return -1;
+        }
+    }
+    mlq_sim_run(&ref);
+
+    int mismatches = 0;
+    if (ref.makespan != sim->makespan || ref.steps != sim->steps) {
+        fprintf(stderr, "check: makespan/steps %d/%lld, reference %d/%lld\n",
+                sim->makespan, sim->steps, ref.makespan, ref.steps);
+        mismatches++;
+    }
+    for (int i = 0; i < sim->process_count; i++) {
+        const MlqProcess *a = &sim->processes[i];
+        const MlqProcess *b = &ref.processes[i];
+        if (a->completion_time != b->completion_time || a->response_time != b->response_time) {
+            if (mismatches < 10) {
+                char name[16];
+                mlq_process_name(i, name, sizeof(name));
+                fprintf(stderr, "check: %s CT/RT %d/%d, reference %d/%d\n", name,
+                        a->completion_time, a->response_time, b->completion_time, b->response_time);
+            }
+            mismatches++;
+        }
+    }
+    mlq_sim_free(&ref);
+
+    if (mismatches == 0) printf("check:            identical to reference\n");
+    return mismatches;
+}
+
+// Run the workload without and with preemption; response and waiting
+// time per priority level side by side
+static int compare_preemption(const MlqSim *sim) {
+    MlqSim runs[2];
+    MlqMetrics stats[2];
+    int ready = 0, status = 0;
+    for (int mode = 0; mode < 2 && status == 0; mode++) {
+        MlqConfig cfg = sim->config;
+        cfg.preempt = mode;
+        cfg.record_timeline = 0;
+        if (mlq_sim_init(&runs[mode], &cfg) < 0) {
+            status = -1;
+            break;
+        }
+        for (int i = 0; i < sim->process_count && status == 0; i++) {
+            const MlqProcess *p = &sim->processes[i];
+            if (mlq_sim_add_process(&runs[mode], p->arrival_time, p->burst_time, p->original_priority) < 0) {
+                status = -1;
+            }
+        }
+        if (status == 0) status = mlq_metrics_init(&stats[mode], &runs[mode]);
+        if (status < 0) {
+            mlq_sim_free(&runs[mode]);
+            break;
+        }
+        ready++;
+        runs[mode].on_event = mlq_metrics_on_event;
+        runs[mode].event_user = &stats[mode];
+        mlq_sim_run(&runs[mode]);
+        if (runs[mode].policy_failed) status = -1;
+    }
+
+    if (status == 0) {
+        static const char *modes[2] = {"non-preemptive", "preemptive"};
+        printf("%-15s | %-31s | %s\n", "", modes[0], modes[1]);
+        printf("%-6s %8s", "level", "jobs");
+        for (int mode = 0; mode < 2; mode++) printf(" | %8s %6s %8s %6s", "resp", "p99", "wait", "p99");
+        printf("\n");
+        for (int q = 0; q <= NUM_QUEUES; q++) {
+            if (q < NUM_QUEUES) printf("%-6d", q + 1);
+            else printf("%-6s", "all");
+            printf(" %8lld", stats[0].series[q][MLQ_METRIC_RESPONSE].stats.count);
+            for (int mode = 0; mode < 2; mode++) {
+                const MlqSeries *row = stats[mode].series[q];
+                printf(" | %8.2f %6d %8.2f %6d", row[MLQ_METRIC_RESPONSE].stats.mean,
+                       mlq_series_quantile(&row[MLQ_METRIC_RESPONSE], 0.99), row[MLQ_METRIC_WAITING].stats.mean,
+                       mlq_series_quantile(&row[MLQ_METRIC_WAITING], 0.99));
+            }
+            printf("\n");
+        }
+        printf("%-15s | %31d | %31d\n", "makespan", runs[0].makespan, runs[1].makespan);
+        printf("%-15s | %31lld | %31lld\n", "switches", stats[0].context_switches, stats[1].context_switches);
+        printf("%-15s | %31lld | %31lld\n", "preemptions", stats[0].preemptions, stats[1].preemptions);
+    }
+    for (int mode = 0; mode < ready; mode++) {
+        mlq_metrics_free(&stats[mode]);
+        mlq_sim_free(&runs[mode]);
+    }
+    if (status < 0) fprintf(stderr, "out of memory for the preemption comparison\n");
+    return status;
+}
+
+static int run_sweep(const MlqSim *sim, const MlqSweepSpec *spec, const char *out_path) {
+    // The sweep works from a workload so every worker loads the same jobs
+    MlqWorkload wl;
+    mlq_workload_init(&wl);
+    if (mlq_workload_reserve(&wl, sim->process_count) < 0) return -1;
+    for (int i = 0; i < sim->process_count; i++) {
+        const MlqProcess *p = &sim->processes[i];
+        mlq_workload_push(&wl, p->arrival_time, p->burst_time, p->original_priority);
+    }
+
+    MlqSweepResult *results;
+    int count;
+    clock_t start = clock();
+    double wall_start = mlq_wall_seconds();
+    int status = mlq_sweep_run(&wl, &sim->config, spec, &results, &count);
+    mlq_workload_free(&wl);
+    if (status < 0) {
+        fprintf(stderr, "sweep failed\n");
+        return -1;
+    }
+
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror(out_path);
+        free(results);
+        return -1;
+    }
+    mlq_sweep_write_csv(out, results, count);
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "swept %d configurations in %.2fs wall, %.2fs cpu\n", count,
+            mlq_wall_seconds() - wall_start, (double)(clock() - start) / CLOCKS_PER_SEC);
+    free(results);
+    return 0;
+}
+
+// Events go to whichever of the metrics, trace and live feed are enabled
+typedef struct {
+    MlqMetrics *metrics;
+    MlqTrace *trace;
+    MlqShm *shm;
+} EventSinks;
+
+static void on_event(const MlqEvent *ev, void *user) {
+    EventSinks *sinks = user;
+    if (sinks->metrics) mlq_metrics_on_event(ev, sinks->metrics);
+    if (sinks->trace) mlq_trace_event(sinks->trace, ev);
+    if (sinks->shm) mlq_shm_event(sinks->shm, ev);
+}
+
+static int ends_with(const char *s, const char *suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static int write_profile(const char *folded_path) {
+    mlq_profile_report(stderr);
+    if (folded_path && mlq_profile_write_folded(folded_path) < 0) {
+        perror(folded_path);
+        return -1;
+    }
+    return 0;
+}
+
+static int write_metrics(const MlqMetrics *m, int json, const char *out_path) {
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror(out_path);
+        return -1;
+    }
+    if (json) mlq_metrics_write_json(out, m);
+    else mlq_metrics_write_csv(out, m);
+    if (out != stdout) fclose(out);
+    return 0;
+}
+
+static void print_report(const MlqSim *sim, int quiet) {
+    double sum_tat = 0, sum_wt = 0, sum_rt = 0;
+
+    if (!quiet) printf("%-10s %6s %6s %4s %6s %6s %6s %6s\n",
+                       "Process", "AT", "BT", "PR", "CT", "TAT", "WT", "RT");
+    for (int i = 0; i < sim->process_count; i++) {
+        const MlqProcess *p = &sim->processes[i];
+        sum_tat += p->turnaround_time;
+        sum_wt += p->waiting_time;
+        sum_rt += p->response_time;
+        if (!quiet) {
+            char name[16];
+            mlq_process_name(i, name, sizeof(name));
+            printf("%-10s %6d %6d %4d %6d %6d %6d %6d\n", name, p->arrival_time, p->burst_time,
+                   p->original_priority, p->completion_time, p->turnaround_time,
+                   p->waiting_time, p->response_time);
+        }
+    }
+
+    int n = sim->process_count > 0 ? sim->process_count : 1;
+    printf("policy:           %s\n", sim->policy->name);
+    printf("processes:        %d\n", sim->process_count);
+    printf("makespan:         %d\n", sim->makespan);
+    printf("avg turnaround:   %.2f\n", sum_tat / n);
+    printf("avg waiting:      %.2f\n", sum_wt / n);
+    printf("avg response:     %.2f\n", sum_rt / n);
+
+    int *scratch = malloc(sizeof(int) * n);
+    if (scratch) {
+        for (int i = 0; i < sim->process_count; i++) scratch[i] = sim->processes[i].response_time;
+        printf("p99 response:     %.0f\n", mlq_p99(scratch, sim->process_count));
+        free(scratch);
+    }
+    if (sim->makespan > 0) printf("throughput:       %.4f per tick\n", (double)sim->process_count / sim->makespan);
+
+    if (sim->cpu_count > 1) {
+        printf("%-6s %8s %10s %10s\n", "CPU", "util", "dispatches", "migrated");
+        for (int c = 0; c < sim->cpu_count; c++) {
+            const MlqCpu *cpu = &sim->cpus[c];
+            double util = sim->makespan > 0 ? 100.0 * cpu->busy_time / sim->makespan : 0;
+            printf("%-6d %7.1f%% %10lld %10lld\n", c, util, cpu->dispatches, cpu->migrations_in);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    MlqConfig cfg;
+    mlq_config_default(&cfg);
+    cfg.timeline_budget = (size_t)64 * 1024 * 1024;
+    const char *path = NULL;
+    int repeat = 1;
+    int quiet = 0;
+    int check = 0;
+    int compare_preempt = 0;
+    int generate = 0;
+    int sweep = 0;
+    const char *sweep_out = NULL;
+    MlqSweepSpec spec;
+    int sweep_set[NUM_QUEUES + 3] = {0};
+    MlqRange sweep_ranges[NUM_QUEUES + 3];
+    int threads = 0;
+    const char *save_path = NULL;
+    const char *import_path = NULL;
+    int import_tick = 1000;
+    const char *sample_path = NULL;
+    int sample_interval = 10;
+    double sample_seconds = 10;
+    int metrics = 0;                // 1 json, 2 csv
+    const char *metrics_out = NULL;
+    int trace = 0;
+    MlqTraceFormat trace_format = MLQ_TRACE_JSON;
+    const char *trace_out = NULL;
+    int profile = 0;
+    const char *shm_name = NULL;
+    const char *profile_out = NULL;
+    MlqGenParams gen;
+    mlq_gen_params_default(&gen);
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--policy") == 0 && val) {
+            if (mlq_policy_parse(val, &cfg.policy) < 0) {
+                fprintf(stderr, "bad --policy value '%s'\n", val);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--aging") == 0 && val) {
+            cfg.aging_threshold = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--decrease") == 0 && val) {
+            cfg.decrease_threshold = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--tq") == 0 && val) {
+            if (parse_tq(val, cfg.time_quantum) < 0) {
+                fprintf(stderr, "bad --tq value '%s'\n", val);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--cpus") == 0 && val) {
+            cfg.num_cpus = atoi(val);
+            if (cfg.num_cpus < 1 || cfg.num_cpus > MLQ_MAX_CPUS) {
+                fprintf(stderr, "--cpus must be 1..%d\n", MLQ_MAX_CPUS);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--balance") == 0 && val) {
+            if (parse_balance(val, &cfg.balance) < 0) {
+                fprintf(stderr, "bad --balance value '%s'\n", val);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--affinity") == 0) {
+            cfg.pin_affinity = 1;
+        } else if (strcmp(arg, "--preempt") == 0) {
+            cfg.preempt = 1;
+        } else if (strcmp(arg, "--repeat") == 0 && val) {
+            repeat = atoi(val);
+            if (repeat < 1) repeat = 1;
+            i++;
+        } else if (strcmp(arg, "--generate") == 0 && val) {
+            generate = 1;
+            gen.count = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && val) {
+            gen.seed = strtoull(val, NULL, 10);
+            i++;
+        } else if (strcmp(arg, "--mean-gap") == 0 && val) {
+            gen.mean_interarrival = atof(val);
+            i++;
+        } else if (strcmp(arg, "--burst-alpha") == 0 && val) {
+            gen.burst_alpha = atof(val);
+            i++;
+        } else if (strcmp(arg, "--burst-max") == 0 && val) {
+            gen.burst_max = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--mix") == 0 && val) {
+            if (parse_mix(val, gen.priority_mix) < 0) {
+                fprintf(stderr, "bad --mix value '%s'\n", val);
+                return 2;
+            }
+            i++;
+        } else if (strncmp(arg, "--sweep-", 8) == 0 && strcmp(arg, "--sweep-out") != 0 && val) {
+            int slot = -1;
+            if (strcmp(arg + 8, "aging") == 0) slot = 0;
+            else if (strcmp(arg + 8, "decrease") == 0) slot = 1;
+            else if (strncmp(arg + 8, "tq", 2) == 0 && atoi(arg + 10) >= 1 && atoi(arg + 10) <= NUM_QUEUES) {
+                slot = 1 + atoi(arg + 10);
+            } else if (strcmp(arg + 8, "cpus") == 0) {
+                slot = NUM_QUEUES + 2;
+            }
+            if (slot < 0 || mlq_range_parse(&sweep_ranges[slot], val) < 0 ||
+                (slot == NUM_QUEUES + 2 && (sweep_ranges[slot].lo < 1 || sweep_ranges[slot].hi > MLQ_MAX_CPUS))) {
+                fprintf(stderr, "bad %s range '%s'\n", arg, val);
+                return 2;
+            }
+            sweep_set[slot] = 1;
+            sweep = 1;
+            i++;
+        } else if (strcmp(arg, "--sweep-out") == 0 && val) {
+            sweep_out = val;
+            i++;
+        } else if (strcmp(arg, "--threads") == 0 && val) {
+            threads = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--import") == 0 && val) {
+            import_path = val;
+            i++;
+        } else if (strcmp(arg, "--import-tick") == 0 && val) {
+            import_tick = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--sample-proc") == 0 && val) {
+            sample_path = val;
+            i++;
+        } else if (strcmp(arg, "--sample-interval") == 0 && val) {
+            sample_interval = atoi(val);
+            i++;
+        } else if (strcmp(arg, "--sample-seconds") == 0 && val) {
+            sample_seconds = atof(val);
+            i++;
+        } else if (strcmp(arg, "--save-workload") == 0 && val) {
+            save_path = val;
+            i++;
+        } else if (strcmp(arg, "--timeline") == 0 && val) {
+            cfg.record_timeline = 1;
+            cfg.timeline_path = val;
+            i++;
+        } else if (strcmp(arg, "--timeline-budget") == 0 && val) {
+            cfg.timeline_budget = (size_t)atoi(val) * 1024 * 1024;
+            i++;
+        } else if (strcmp(arg, "--metrics") == 0 && val) {
+            if (strcmp(val, "json") == 0) metrics = 1;
+            else if (strcmp(val, "csv") == 0) metrics = 2;
+            else {
+                fprintf(stderr, "bad --metrics value '%s'\n", val);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--metrics-out") == 0 && val) {
+            metrics_out = val;
+            i++;
+        } else if (strcmp(arg, "--trace") == 0 && val) {
+            if (mlq_trace_parse_format(val, &trace_format) < 0) {
+                fprintf(stderr, "bad --trace value '%s'\n", val);
+                return 2;
+            }
+            trace = 1;
+            i++;
+        } else if (strcmp(arg, "--trace-out") == 0 && val) {
+            trace_out = val;
+            i++;
+        } else if (strcmp(arg, "--shm") == 0 && val) {
+            shm_name = val;
+            i++;
+        } else if (strcmp(arg, "--profile") == 0) {
+            profile = 1;
+        } else if (strcmp(arg, "--profile-out") == 0 && val) {
+            profile = 1;
+            profile_out = val;
+            i++;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            quiet = 1;
+        } else if (strcmp(arg, "--check") == 0) {
+            check = 1;
+        } else if (strcmp(arg, "--compare-preempt") == 0) {
+            compare_preempt = 1;
+        } else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            path = arg;
+        }
+    }
+
+    if (profile && !mlq_profile_enabled()) {
+        fprintf(stderr, "--profile needs a build with -DMLQ_PROFILE\n");
+        return 2;
+    }
+    MLQ_PROF_THREAD("main");
+
+    if (sample_path) {
+        fprintf(stderr, "sampling /proc every %d ms for %g s into %s\n", sample_interval, sample_seconds, sample_path);
+        return mlq_proc_sample(sample_path, sample_interval, sample_seconds) < 0 ? 1 : 0;
+    }
+
+    MlqSim sim;
+    if (mlq_sim_init(&sim, &cfg) < 0) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    MlqWorkload wl;
+    mlq_workload_init(&wl);
+    int wl_status = 0;
+    if (generate) {
+        wl_status = mlq_workload_generate(&wl, &gen);
+        if (wl_status < 0) fprintf(stderr, "bad generator parameters\n");
+    } else if (import_path) {
+        MlqImportStats imported;
+        wl_status = mlq_workload_import(&wl, import_path, import_tick, &imported);
+        if (wl_status == 0) {
+            fprintf(stderr, "imported %s: %lld lines, %lld %s, %lld jobs", import_path, imported.lines,
+                    imported.events, imported.format == MLQ_IMPORT_PERF_SCHED ? "events" : "samples", imported.jobs);
+            if (imported.format == MLQ_IMPORT_PERF_SCHED) fprintf(stderr, " from %d tasks", imported.tasks);
+            if (imported.unparsed > 0) fprintf(stderr, ", %lld lines skipped", imported.unparsed);
+            fputc('\n', stderr);
+            if (imported.jobs == 0) {
+                fprintf(stderr, "%s: no scheduling activity found\n", import_path);
+                wl_status = -1;
+            }
+        }
+    } else if (path) {
+        wl_status = mlq_workload_load(&wl, path);
+    }
+    if (wl_status == 0 && save_path) wl_status = mlq_workload_save_binary(&wl, save_path);
+    if (wl_status == 0 && (generate || import_path || path)) {
+        wl_status = mlq_sim_load_workload(&sim, &wl);
+        if (wl_status < 0) fprintf(stderr, "out of memory\n");
+    } else if (wl_status == 0) {
+        mlq_sim_add_default_processes(&sim);
+    }
+    mlq_workload_free(&wl);
+    if (wl_status < 0) {
+        mlq_sim_free(&sim);
+        return 1;
+    }
+
+    if (sweep) {
+        mlq_sweep_spec_from_config(&spec, &cfg);
+        if (sweep_set[0]) spec.aging = sweep_ranges[0];
+        if (sweep_set[1]) spec.decrease = sweep_ranges[1];
+        for (int q = 0; q < NUM_QUEUES; q++) {
+            if (sweep_set[q + 2]) spec.time_quantum[q] = sweep_ranges[q + 2];
+        }
+        if (sweep_set[NUM_QUEUES + 2]) spec.cpus = sweep_ranges[NUM_QUEUES + 2];
+        spec.threads = threads;
+        int status = run_sweep(&sim, &spec, sweep_out) < 0 ? 1 : 0;
+        if (profile && write_profile(profile_out) < 0) status = 1;
+        mlq_sim_free(&sim);
+        return status;
+    }
+
+    MlqMetrics stats;
+    EventSinks sinks = {NULL, NULL, NULL};
+    if (metrics) {
+        if (mlq_metrics_init(&stats, &sim) < 0) {
+            fprintf(stderr, "out of memory\n");
+            mlq_sim_free(&sim);
+            return 1;
+        }
+        sinks.metrics = &stats;
+    }
+
+    // Only the first run is traced; repeats would draw the same schedule
+    MlqTrace tracer;
+    long long trace_events = 0;
+    int trace_failed = 0;
+    if (trace) {
+        if (!trace_out) trace_out = trace_format == MLQ_TRACE_JSON ? "mlq-trace.json" : "mlq-trace.pftrace";
+        int compress = ends_with(trace_out, ".gz");
+        if (compress && !mlq_trace_can_compress()) {
+            fprintf(stderr, "%s: compression needs a build with -DMLQ_ZLIB -lz\n", trace_out);
+            trace_failed = 1;
+        } else if (mlq_trace_open(&tracer, trace_out, trace_format, compress, &sim) < 0) {
+            perror(trace_out);
+            trace_failed = 1;
+        }
+        if (trace_failed) {
+            if (metrics) mlq_metrics_free(&stats);
+            mlq_sim_free(&sim);
+            return 1;
+        }
+        sinks.trace = &tracer;
+    }
+    MlqShm live;
+    if (shm_name) {
+        if (mlq_shm_create(&live, shm_name, &sim) < 0) {
+            perror(shm_name);
+            if (sinks.trace) mlq_trace_close(sinks.trace);
+            if (metrics) mlq_metrics_free(&stats);
+            mlq_sim_free(&sim);
+            return 1;
+        }
+        sinks.shm = &live;
+    }
+    if (sinks.metrics || sinks.trace || sinks.shm) {
+        sim.on_event = on_event;
+        sim.event_user = &sinks;
+    }
+
+    long long total_steps = 0;
+    clock_t start = clock();
+    for (int r = 0; r < repeat; r++) {
+        if (mlq_sim_reset(&sim) < 0 || (metrics && mlq_metrics_reset(&stats) < 0)) {
+            fprintf(stderr, "out of memory\n");
+            if (sinks.trace) mlq_trace_close(sinks.trace);
+            if (sinks.shm) mlq_shm_close(sinks.shm);
+            if (metrics) mlq_metrics_free(&stats);
+            mlq_sim_free(&sim);
+            return 1;
+        }
+        if (sinks.shm) mlq_shm_reset(sinks.shm);
+        mlq_sim_run(&sim);
+        total_steps += sim.steps;
+        if (sinks.trace) {
+            trace_events = tracer.events;
+            trace_failed = mlq_trace_close(&tracer) < 0;
+            sinks.trace = NULL;
+        }
+    }
+    if (sinks.shm) {
+        mlq_shm_finish(sinks.shm);
+        mlq_shm_close(sinks.shm);
+        sinks.shm = NULL;
+    }
+    if (sim.policy_failed) {
+        fprintf(stderr, "out of memory for the run queues\n");
+        if (metrics) mlq_metrics_free(&stats);
+        mlq_sim_free(&sim);
+        return 1;
+    }
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    print_report(&sim, quiet);
+    printf("steps:            %lld\n", total_steps);
+    if (secs > 0) printf("steps/sec:        %.0f\n", total_steps / secs);
+
+    if (cfg.record_timeline) {
+        if (sim.timeline_failed || mlq_timeline_flush(&sim.timeline) < 0) {
+            fprintf(stderr, "%s: failed to write timeline\n", cfg.timeline_path);
+            mlq_sim_free(&sim);
+            return 1;
+        }
+        printf("timeline slices:  %lld\n", sim.timeline.count);
+    }
+
+    int status = 0;
+    if (trace) {
+        if (trace_failed) {
+            fprintf(stderr, "%s: failed to write trace\n", trace_out);
+            status = 1;
+        } else {
+            printf("trace events:     %lld\n", trace_events);
+        }
+    }
+    if (metrics) {
+        if (write_metrics(&stats, metrics == 1, metrics_out) < 0) status = 1;
+        mlq_metrics_free(&stats);
+    }
+    if (profile && write_profile(profile_out) < 0) status = 1;
+    if (check && check_against_reference(&sim) != 0) status = 1;
+    if (compare_preempt && compare_preemption(&sim) < 0) status = 1;
+
+    mlq_sim_free(&sim);
+    return status;
+}
@@ -0,0 +1,892 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_engine.h"
+#include "mlq_policy.h"
+#include "mlq_profile.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static int compare_keys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sort arrival_order[from..) by (arrival_time, pid); traces usually come
+// in arrival order already, so check before paying for the sort
+static int sort_arrivals(MlqSim *sim, int from) {
+    int *order = sim->arrival_order;
+    const MlqProcess *procs = sim->processes;
+    int n = sim->process_count - from;
+    int sorted = 1;
+
+    for (int i = from + 1; i < sim->process_count && sorted; i++) {
+        const MlqProcess *a = &procs[order[i - 1]];
+        const MlqProcess *b = &procs[order[i]];
+        if (a->arrival_time > b->arrival_time ||
+            (a->arrival_time == b->arrival_time && order[i - 1] > order[i])) sorted = 0;
+    }
+    if (sorted) return 0;
+
+    uint64_t *keys = malloc(sizeof(uint64_t) * n);
+    if (!keys) return -1;
+    for (int i = 0; i < n; i++) {
+        int pid = order[from + i];
+        uint32_t at = (uint32_t)procs[pid].arrival_time ^ 0x80000000u;
+        keys[i] = ((uint64_t)at << 32) | (uint32_t)pid;
+    }
+    qsort(keys, n, sizeof(uint64_t), compare_keys);
+    for (int i = 0; i < n; i++) order[from + i] = (int)(keys[i] & 0xffffffffu);
+    free(keys);
+    return 0;
+}
+
+static void *hot_alloc(size_t bytes) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, 32);
+#else
+    void *ptr;
+    return posix_memalign(&ptr, 32, bytes) == 0 ? ptr : NULL;
+#endif
+}
+
+static void hot_free(void *ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+static void hot_release(MlqHotTable *hot) {
+    hot_free(hot->waited);
+    hot_free(hot->cpu);
+    hot_free(hot->level);
+    memset(hot, 0, sizeof(*hot));
+}
+
+// Aligned storage can't be realloc'ed; the contents are rebuilt at reset
+static int hot_reserve(MlqHotTable *hot, int count) {
+    int capacity = (count + MLQ_HOT_BLOCK - 1) / MLQ_HOT_BLOCK * MLQ_HOT_BLOCK;
+    if (capacity <= hot->capacity) return 0;
+    size_t bytes = sizeof(int) * (size_t)capacity;
+    int *waited = hot_alloc(bytes), *cpu = hot_alloc(bytes), *level = hot_alloc(bytes);
+    if (!waited || !cpu || !level) {
+        hot_free(waited);
+        hot_free(cpu);
+        hot_free(level);
+        return -1;
+    }
+    hot_release(hot);
+    hot->waited = waited;
+    hot->cpu = cpu;
+    hot->level = level;
+    hot->capacity = capacity;
+    for (int r = 0; r < capacity; r++) cpu[r] = -1;
+    return 0;
+}
+
+static void queue_push(MlqSim *sim, MlqCpu *cpu, int level, int pid) {
+    MlqProcess *p = &sim->processes[pid];
+    int tail = cpu->queue_tail[level - 1];
+    p->queue_next = -1;
+    p->queue_prev = tail;
+    if (tail >= 0) sim->processes[tail].queue_next = pid;
+    else cpu->queue_head[level - 1] = pid;
+    cpu->queue_tail[level - 1] = pid;
+}
+
+static void queue_unlink(MlqSim *sim, MlqCpu *cpu, int level, int pid) {
+    MlqProcess *p = &sim->processes[pid];
+    if (p->queue_prev >= 0) sim->processes[p->queue_prev].queue_next = p->queue_next;
+    else cpu->queue_head[level - 1] = p->queue_next;
+    if (p->queue_next >= 0) sim->processes[p->queue_next].queue_prev = p->queue_prev;
+    else cpu->queue_tail[level - 1] = p->queue_prev;
+    p->queue_next = -1;
+    p->queue_prev = -1;
+}
+
+// Fresh CPUs: empty queues, clock 0; the heaps keep their storage
+static void clear_cpus(MlqSim *sim) {
+    for (int c = 0; c < sim->cpu_count; c++) {
+        MlqCpu *cpu = &sim->cpus[c];
+        cpu->clock = 0;
+        cpu->steps = 0;
+        cpu->ready_count = 0;
+        cpu->deadline_count = 0;
+        cpu->tree_root = -1;
+        cpu->heap_count = 0;
+        cpu->vclock = 0;
+        cpu->weight = 0;
+        cpu->busy_time = 0;
+        cpu->dispatches = 0;
+        cpu->migrations_in = 0;
+        cpu->cut_for = -1;
+        for (int q = 0; q < NUM_QUEUES; q++) {
+            cpu->level_count[q] = 0;
+            cpu->queue_head[q] = -1;
+            cpu->queue_tail[q] = -1;
+        }
+    }
+}
+
+static int resize_cpus(MlqSim *sim, int count) {
+    if (count < 1) count = 1;
+    if (count > MLQ_MAX_CPUS) count = MLQ_MAX_CPUS;
+    if (count == sim->cpu_count) return 0;
+
+    long long *work = realloc(sim->cpu_work, sizeof(long long) * count);
+    if (!work) return -1;
+    sim->cpu_work = work;
+    for (int c = count; c < sim->cpu_count; c++) {
+        free(sim->cpus[c].deadlines);
+        free(sim->cpus[c].heap);
+    }
+    MlqCpu *grown = realloc(sim->cpus, sizeof(MlqCpu) * count);
+    if (!grown) return -1;
+    for (int c = sim->cpu_count; c < count; c++) memset(&grown[c], 0, sizeof(MlqCpu));
+    sim->cpus = grown;
+    sim->cpu_count = count;
+    return 0;
+}
+
+void mlq_config_default(MlqConfig *cfg) {
+    cfg->aging_threshold = 5;
+    cfg->decrease_threshold = 3;
+    cfg->time_quantum[0] = 2;
+    cfg->time_quantum[1] = 4;
+    cfg->time_quantum[2] = 8;
+    cfg->record_timeline = 0;
+    cfg->timeline_budget = 0;
+    cfg->timeline_path = NULL;
+    cfg->eager_aging = 0;
+    cfg->num_cpus = 1;
+    cfg->balance = MLQ_BALANCE_STEAL;
+    cfg->pin_affinity = 0;
+    cfg->policy = MLQ_POLICY_MLQ;
+    cfg->preempt = 0;
+}
+
+int mlq_sim_init(MlqSim *sim, const MlqConfig *cfg) {
+    memset(sim, 0, sizeof(*sim));
+    if (cfg) sim->config = *cfg;
+    else mlq_config_default(&sim->config);
+    sim->policy = mlq_policy_get(sim->config.policy);
+
+    if (sim->config.record_timeline &&
+        mlq_timeline_init(&sim->timeline, sim->config.timeline_budget, sim->config.timeline_path) < 0) {
+        return -1;
+    }
+    if (resize_cpus(sim, sim->config.num_cpus) < 0) {
+        mlq_timeline_free(&sim->timeline);
+        return -1;
+    }
+    clear_cpus(sim);
+    return 0;
+}
+
+void mlq_sim_free(MlqSim *sim) {
+    free(sim->processes);
+    free(sim->arrival_order);
+    hot_release(&sim->hot);
+    for (int c = 0; c < sim->cpu_count; c++) {
+        free(sim->cpus[c].deadlines);
+        free(sim->cpus[c].heap);
+    }
+    free(sim->cpus);
+    free(sim->cpu_work);
+    mlq_timeline_free(&sim->timeline);
+    memset(sim, 0, sizeof(*sim));
+}
+
+int mlq_sim_reserve(MlqSim *sim, int capacity) {
+    if (capacity <= sim->process_capacity) return 0;
+    MlqProcess *grown = realloc(sim->processes, sizeof(MlqProcess) * capacity);
+    if (!grown) return -1;
+    sim->processes = grown;
+    int *order = realloc(sim->arrival_order, sizeof(int) * capacity);
+    if (!order) return -1;
+    sim->arrival_order = order;
+    if (hot_reserve(&sim->hot, capacity) < 0) return -1;
+    sim->process_capacity = capacity;
+    return 0;
+}
+
+void mlq_sim_clear_processes(MlqSim *sim) {
+    sim->process_count = 0;
+    mlq_sim_reset(sim);
+}
+
+int mlq_sim_add_process(MlqSim *sim, int arrival_time, int burst_time, int priority) {
+    if (sim->process_count == sim->process_capacity &&
+        mlq_sim_reserve(sim, sim->process_capacity ? sim->process_capacity * 2 : 16) < 0) {
+        return -1;
+    }
+
+    if (priority < 1) priority = 1;
+    if (priority > NUM_QUEUES) priority = NUM_QUEUES;
+
+    int pid = sim->process_count++;
+    MlqProcess *p = &sim->processes[pid];
+    memset(p, 0, sizeof(*p));
+    p->arrival_time = arrival_time;
+    p->burst_time = burst_time;
+    p->remaining_time = burst_time;
+    p->priority = priority;
+    p->original_priority = priority;
+    p->queue_next = -1;
+    p->queue_prev = -1;
+    p->wait_mark = -1;
+    p->demote_at = -1;
+    p->cpu = -1;
+    p->tree_left = -1;
+    p->tree_right = -1;
+    p->heap_index = -1;
+    if (burst_time <= 0) sim->finished_count++;
+
+    // Kept unsorted until the next step or reset sorts the pending tail
+    sim->arrival_order[pid] = pid;
+    sim->order_dirty = 1;
+    return pid;
+}
+
+// The seven processes the GUI has always started with
+void mlq_sim_add_default_processes(MlqSim *sim) {
+    const int default_data[][3] = {
+        {1, 20, 3},   // P1: AT=1, BT=20, Priority=3
+        {3, 10, 2},   // P2: AT=3, BT=10, Priority=2
+        {5, 2, 1},    // P3: AT=5, BT=2, Priority=1
+        {8, 7, 2},    // P4: AT=8, BT=7, Priority=2
+        {11, 15, 3},  // P5: AT=11, BT=15, Priority=3
+        {15, 8, 2},   // P6: AT=15, BT=8, Priority=2
+        {20, 4, 1}    // P7: AT=20, BT=4, Priority=1
+    };
+
+    for (int i = 0; i < 7; i++) {
+        mlq_sim_add_process(sim, default_data[i][0], default_data[i][1], default_data[i][2]);
+    }
+}
+
+void mlq_process_reset(MlqProcess *p) {
+    p->remaining_time = p->burst_time;
+    p->priority = p->original_priority;
+    p->time_executing = 0;
+    p->completion_time = 0;
+    p->turnaround_time = 0;
+    p->waiting_time = 0;
+    p->response_time = 0;
+    p->has_started = 0;
+    p->queue_next = -1;
+    p->queue_prev = -1;
+    p->wait_mark = -1;
+    p->demote_at = -1;
+    p->cpu = -1;
+    p->ready_at = 0;
+    p->sched_key = 0;
+    p->tree_left = -1;
+    p->tree_right = -1;
+    p->tree_height = 0;
+    p->heap_index = -1;
+}
+
+int mlq_sim_reset(MlqSim *sim) {
+    int rc = resize_cpus(sim, sim->config.num_cpus);
+    sim->policy = mlq_policy_get(sim->config.policy);
+    sim->policy_failed = 0;
+    sim->current_time = 0;
+    sim->makespan = 0;
+    sim->steps = 0;
+    mlq_timeline_clear(&sim->timeline);
+    sim->timeline_failed = 0;
+    sim->finished_count = 0;
+    sim->ready_count = 0;
+    sim->admit_cursor = 0;
+    clear_cpus(sim);
+    for (int r = 0; r < sim->hot.capacity; r++) {
+        sim->hot.waited[r] = 0;
+        sim->hot.cpu[r] = -1;
+        sim->hot.level[r] = 0;
+    }
+
+    for (int i = 0; i < sim->process_count; i++) {
+        MlqProcess *p = &sim->processes[i];
+        mlq_process_reset(p);
+        if (p->burst_time <= 0) sim->finished_count++;
+    }
+
+    // Arrival times may have been edited since the last run
+    sim->order_dirty = 1;
+    return rc;
+}
+
+static void emit(MlqSim *sim, MlqEventKind kind, int pid, int time, int duration, int queue_level, int cpu) {
+    if (!sim->on_event) return;
+    MlqEvent ev = {kind, pid, time, duration, queue_level, cpu};
+    MLQ_PROF_BEGIN(MLQ_ZONE_EVENT);
+    sim->on_event(&ev, sim->event_user);
+    MLQ_PROF_END(MLQ_ZONE_EVENT);
+}
+
+static void record_slice(MlqSim *sim, int cpu, int pid, int start, int duration, int queue_level) {
+    if (!sim->config.record_timeline) return;
+    MLQ_PROF_BEGIN(MLQ_ZONE_TIMELINE);
+    if (mlq_timeline_append(&sim->timeline, cpu, pid, start, duration, queue_level) < 0) sim->timeline_failed = 1;
+    MLQ_PROF_END(MLQ_ZONE_TIMELINE);
+}
+
+static int deadline_before(const MlqDeadline *a, const MlqDeadline *b) {
+    return a->step < b->step || (a->step == b->step && a->rank < b->rank);
+}
+
+static int deadline_push(MlqCpu *cpu, long long step, int rank, int pid) {
+    if (cpu->deadline_count == cpu->deadline_capacity) {
+        int cap = cpu->deadline_capacity ? cpu->deadline_capacity * 2 : 64;
+        MlqDeadline *grown = realloc(cpu->deadlines, sizeof(MlqDeadline) * cap);
+        if (!grown) return -1;
+        cpu->deadlines = grown;
+        cpu->deadline_capacity = cap;
+    }
+
+    MlqDeadline *heap = cpu->deadlines;
+    MlqDeadline d = {step, rank, pid};
+    int i = cpu->deadline_count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!deadline_before(&d, &heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = d;
+    return 0;
+}
+
+static MlqDeadline deadline_pop(MlqCpu *cpu) {
+    MlqDeadline *heap = cpu->deadlines;
+    MlqDeadline top = heap[0];
+    MlqDeadline last = heap[--cpu->deadline_count];
+    int n = cpu->deadline_count;
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && deadline_before(&heap[child + 1], &heap[child])) child++;
+        if (!deadline_before(&heap[child], &last)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (n > 0) heap[i] = last;
+    return top;
+}
+
+// Restart the waiting count at step `mark` of the process's CPU and
+// schedule the demotion the counter would reach, matching
+// "waited >= decrease_threshold" in the eager pass
+static void restart_wait(MlqSim *sim, int pid, long long mark) {
+    MlqProcess *p = &sim->processes[pid];
+    p->wait_mark = mark;
+    p->demote_at = -1;
+    if (sim->config.eager_aging || p->priority >= NUM_QUEUES) return;
+
+    int threshold = sim->config.decrease_threshold > 1 ? sim->config.decrease_threshold : 1;
+    if (deadline_push(&sim->cpus[p->cpu], mark + threshold, p->arrival_rank, pid) == 0) {
+        p->demote_at = mark + threshold;
+    }
+}
+
+// A process arrives on or migrates to a CPU
+static void enqueue_on(MlqSim *sim, int c, int pid) {
+    sim->processes[pid].cpu = c;
+    sim->hot.cpu[sim->processes[pid].arrival_rank] = c;
+    sim->cpus[c].ready_count++;
+    sim->cpus[c].level_count[sim->processes[pid].priority - 1]++;
+    if (sim->policy->enqueue(sim, c, pid, 1) < 0) sim->policy_failed = 1;
+}
+
+static void migrate(MlqSim *sim, int pid, int dest, int now) {
+    MlqProcess *p = &sim->processes[pid];
+    int from = p->cpu;
+    sim->policy->remove(sim, from, pid);
+    sim->cpus[from].ready_count--;
+    sim->cpus[from].level_count[p->priority - 1]--;
+    enqueue_on(sim, dest, pid);
+    sim->cpus[dest].migrations_in++;
+    MLQ_PROF_COUNT(MLQ_COUNT_MIGRATE, 1);
+    emit(sim, MLQ_EV_MIGRATE, pid, now, 0, p->priority, dest);
+}
+
+static int balance_has(const MlqConfig *cfg, MlqBalance mode) {
+    if (cfg->pin_affinity || cfg->balance == MLQ_BALANCE_NONE) return 0;
+    return cfg->balance == MLQ_BALANCE_BOTH || cfg->balance == mode;
+}
+
+// Fewest queued processes, then the earliest clock, then the lowest index
+static int least_loaded(const MlqSim *sim, int except) {
+    int best = -1;
+    for (int c = 0; c < sim->cpu_count; c++) {
+        const MlqCpu *cpu = &sim->cpus[c];
+        if (c == except) continue;
+        if (best < 0 || cpu->ready_count < sim->cpus[best].ready_count ||
+            (cpu->ready_count == sim->cpus[best].ready_count && cpu->clock < sim->cpus[best].clock)) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+static int place(const MlqSim *sim, int pid) {
+    if (sim->cpu_count == 1) return 0;
+    if (sim->config.pin_affinity) return pid % sim->cpu_count;
+    return least_loaded(sim, -1);
+}
+
+// First process on the CPU, in dispatch order, free to run by `time`
+static int mlq_first_ready(const MlqSim *sim, int c, int time) {
+    const MlqCpu *cpu = &sim->cpus[c];
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        for (int i = cpu->queue_head[q]; i >= 0; i = sim->processes[i].queue_next) {
+            MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, 1);
+            if (sim->processes[i].ready_at <= time) return i;
+        }
+    }
+    return -1;
+}
+
+// Last process in dispatch order (lowest level, tail first) free by `time`
+static int mlq_last_ready(const MlqSim *sim, int c, int time) {
+    const MlqCpu *cpu = &sim->cpus[c];
+    for (int q = NUM_QUEUES - 1; q >= 0; q--) {
+        for (int i = cpu->queue_tail[q]; i >= 0; i = sim->processes[i].queue_prev) {
+            MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, 1);
+            if (sim->processes[i].ready_at <= time) return i;
+        }
+    }
+    return -1;
+}
+
+// An idle CPU takes the next runnable process of the busiest CPU
+static int steal(MlqSim *sim, int c, int now) {
+    int victim = -1, pid = -1;
+    for (int v = 0; v < sim->cpu_count; v++) {
+        if (v == c || sim->cpus[v].ready_count == 0) continue;
+        if (victim >= 0 && sim->cpus[v].ready_count <= sim->cpus[victim].ready_count) continue;
+        int candidate = sim->policy->first_ready(sim, v, now);
+        if (candidate < 0) continue;
+        victim = v;
+        pid = candidate;
+    }
+    if (pid < 0) return 0;
+    migrate(sim, pid, c, now);
+    return 1;
+}
+
+// An overloaded CPU hands its least urgent runnable process to the least
+// loaded CPU once the gap is two or more
+static void push(MlqSim *sim, int c, int now) {
+    MlqCpu *self = &sim->cpus[c];
+    int dest = least_loaded(sim, c);
+    if (dest < 0 || self->ready_count - sim->cpus[dest].ready_count < 2) return;
+    int pid = sim->policy->last_ready(sim, c, sim->cpus[dest].clock);
+    if (pid >= 0) migrate(sim, pid, dest, now);
+}
+
+// Only for a process on a CPU's run queue or running there
+static void set_level(MlqSim *sim, MlqProcess *p, int level) {
+    sim->cpus[p->cpu].level_count[p->priority - 1]--;
+    sim->cpus[p->cpu].level_count[level - 1]++;
+    p->priority = level;
+    sim->hot.level[p->arrival_rank] = level;
+}
+
+static void demote(MlqSim *sim, MlqCpu *cpu, int pid, int now) {
+    MlqProcess *p = &sim->processes[pid];
+    queue_unlink(sim, cpu, p->priority, pid);
+    set_level(sim, p, p->priority + 1);
+    sim->hot.waited[p->arrival_rank] = 0;
+    p->time_executing = 0;
+    queue_push(sim, cpu, p->priority, pid);
+    restart_wait(sim, pid, cpu->steps);
+    MLQ_PROF_COUNT(MLQ_COUNT_DEMOTE, 1);
+    emit(sim, MLQ_EV_DEMOTE, pid, now, 0, p->priority, p->cpu);
+}
+
+static int lowest_bit(unsigned v) {
+#ifdef __GNUC__
+    return __builtin_ctz(v);
+#else
+    int bit = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// One block of the eager aging pass: count a waiting step for every
+// process queued on CPU c, and return a bit for each that reached the
+// threshold above the lowest level. The scalar form is branch-free so the
+// compiler can vectorise it where AVX2 isn't enabled.
+static unsigned age_block(int *waited, const int *cpu, const int *level, int c, int threshold) {
+    unsigned due = 0;
+#ifdef __AVX2__
+    const __m256i self = _mm256_set1_epi32(c);
+    const __m256i below = _mm256_set1_epi32(threshold - 1);
+    const __m256i lowest = _mm256_set1_epi32(NUM_QUEUES);
+    for (int h = 0; h < MLQ_HOT_BLOCK; h += 8) {
+        __m256i here = _mm256_cmpeq_epi32(_mm256_load_si256((const __m256i *)(cpu + h)), self);
+        __m256i w = _mm256_sub_epi32(_mm256_load_si256((const __m256i *)(waited + h)), here);
+        _mm256_store_si256((__m256i *)(waited + h), w);
+        __m256i d = _mm256_and_si256(here, _mm256_cmpgt_epi32(w, below));
+        d = _mm256_and_si256(d, _mm256_cmpgt_epi32(lowest, _mm256_load_si256((const __m256i *)(level + h))));
+        due |= (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(d)) << h;
+    }
+#else
+    for (int j = 0; j < MLQ_HOT_BLOCK; j++) {
+        int here = cpu[j] == c;
+        waited[j] += here;
+        due |= (unsigned)(here & (waited[j] >= threshold) & (level[j] < NUM_QUEUES)) << j;
+    }
+#endif
+    return due;
+}
+
+// Reference pass: bump every waiting counter on this CPU, demote at the
+// threshold. Demotions go in arrival order, as the counters are scanned.
+static void age_eager(MlqSim *sim, int c, int now) {
+    MlqHotTable *hot = &sim->hot;
+    int threshold = sim->config.decrease_threshold > 1 ? sim->config.decrease_threshold : 1;
+    MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, sim->admit_cursor);
+    for (int base = 0; base < sim->admit_cursor; base += MLQ_HOT_BLOCK) {
+        unsigned due = age_block(hot->waited + base, hot->cpu + base, hot->level + base, c, threshold);
+        while (due) {
+            int j = lowest_bit(due);
+            due &= due - 1;
+            demote(sim, &sim->cpus[c], sim->arrival_order[base + j], now);
+        }
+    }
+}
+
+// Only touch processes whose demotion step has come. Entries left behind
+// by a migration are stale too.
+static void age_lazy(MlqSim *sim, int c, int now) {
+    MlqCpu *cpu = &sim->cpus[c];
+    while (cpu->deadline_count > 0 && cpu->deadlines[0].step <= cpu->steps) {
+        MlqDeadline d = deadline_pop(cpu);
+        MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, 1);
+        MlqProcess *p = &sim->processes[d.pid];
+        if (p->remaining_time <= 0 || p->cpu != c || p->demote_at != d.step) continue;
+        demote(sim, cpu, d.pid, now);
+    }
+}
+
+// MLQ policy: one FIFO per level on each CPU, demotion after waiting
+// decrease_threshold steps, promotion after running aging_threshold ticks
+
+static int mlq_enqueue(MlqSim *sim, int c, int pid, int wakeup) {
+    MlqCpu *cpu = &sim->cpus[c];
+    MlqProcess *p = &sim->processes[pid];
+    sim->hot.waited[p->arrival_rank] = 0;
+    queue_push(sim, cpu, p->priority, pid);
+    // On the CPU that is stepping, a wakeup's wait already counts this step
+    restart_wait(sim, pid, wakeup && c == sim->active_cpu ? cpu->steps - 1 : cpu->steps);
+    return 0;
+}
+
+static void mlq_remove(MlqSim *sim, int c, int pid) {
+    queue_unlink(sim, &sim->cpus[c], sim->processes[pid].priority, pid);
+}
+
+// Demote whoever waited too long, then take the head of the highest
+// priority non-empty queue
+static int mlq_pick_next(MlqSim *sim, int c, int now) {
+    MlqCpu *cpu = &sim->cpus[c];
+    MLQ_PROF_BEGIN(MLQ_ZONE_AGING);
+    if (sim->config.eager_aging) age_eager(sim, c, now);
+    else age_lazy(sim, c, now);
+    MLQ_PROF_END(MLQ_ZONE_AGING);
+
+    int priority = 1;
+    while (cpu->queue_head[priority - 1] < 0) priority++;
+    int pid = cpu->queue_head[priority - 1];
+    queue_unlink(sim, cpu, priority, pid);
+    return pid;
+}
+
+static int mlq_slice(const MlqSim *sim, int c, int pid) {
+    const MlqProcess *p = &sim->processes[pid];
+    int slice = sim->config.time_quantum[p->priority - 1];
+    // Preemptive: stop at the tick the promotion is earned, so it takes effect there
+    if (sim->config.preempt && p->priority > 1) {
+        int left = sim->config.aging_threshold - p->time_executing;
+        if (left > 0 && left < slice) slice = left;
+    }
+    return slice;
+}
+
+// Aging (promotion) after executing long enough
+static void mlq_tick(MlqSim *sim, int c, int pid, int ran, int now) {
+    MlqProcess *p = &sim->processes[pid];
+    if (p->time_executing >= sim->config.aging_threshold && p->priority > 1 && p->remaining_time > 0) {
+        set_level(sim, p, p->priority - 1);
+        p->time_executing = 0;
+        sim->hot.waited[p->arrival_rank] = 0;
+        emit(sim, MLQ_EV_PROMOTE, pid, now, 0, p->priority, c);
+    }
+}
+
+static void mlq_on_complete(MlqSim *sim, int c, int pid) {
+    sim->processes[pid].demote_at = -1;
+}
+
+const MlqPolicy mlq_policy_mlq = {
+    "mlq", mlq_enqueue, mlq_remove, mlq_pick_next, mlq_slice, mlq_tick, mlq_on_complete,
+    mlq_first_ready, mlq_last_ready,
+};
+
+// CPU whose slice a pending arrival already cut, or -1
+static int cut_by(const MlqSim *sim, int pid) {
+    for (int c = 0; c < sim->cpu_count; c++) {
+        if (sim->cpus[c].cut_for == pid) return c;
+    }
+    return -1;
+}
+
+// Arrival time of the first process due before `end` that outranks a
+// process at `level` and is bound for CPU c, or `end`. Where an unpinned
+// arrival goes is settled here, as if it came now, and it is held for c
+// so no other CPU cuts for it. Everything not yet admitted arrives after
+// `now`, so a cut slice is never empty.
+static int preemption_point(MlqSim *sim, int c, int level, int end) {
+    for (int r = sim->admit_cursor; r < sim->process_count; r++) {
+        int pid = sim->arrival_order[r];
+        const MlqProcess *p = &sim->processes[pid];
+        if (p->arrival_time >= end) break;
+        if (p->priority >= level || p->remaining_time <= 0) continue;
+        int dest = cut_by(sim, pid);
+        if (dest < 0) dest = place(sim, pid);
+        if (dest != c) continue;
+        sim->cpus[c].cut_for = pid;
+        return p->arrival_time;
+    }
+    return end;
+}
+
+// When idle CPU c could next find work: the next arrival it may be given,
+// or, with balancing, the clock of a CPU holding two or more processes,
+// by which all of them are free to be stolen or pushed. Idle CPUs have
+// nothing to give, so they never wake each other. When none of that can
+// happen, c is done for the run and sleeps until the others drain.
+static int idle_until(const MlqSim *sim, int c, int now) {
+    const MlqConfig *cfg = &sim->config;
+    int n = sim->process_count;
+    int next = INT_MAX;
+    int r = sim->admit_cursor;
+    while (r < n) {
+        int t = sim->processes[sim->arrival_order[r]].arrival_time;
+        int due = 0;
+        for (; r < n && sim->processes[sim->arrival_order[r]].arrival_time == t; r++) {
+            if (!cfg->pin_affinity || sim->arrival_order[r] % sim->cpu_count == c) due++;
+        }
+        if (due == 0) continue;
+        // Arrivals go to idle CPUs with the earliest clock first, so those
+        // already waiting for `t` take them if there are enough of them
+        if (!cfg->pin_affinity) {
+            int waiting = 0;
+            for (int k = 0; k < sim->cpu_count; k++) {
+                if (k != c && sim->cpus[k].ready_count == 0 && sim->cpus[k].clock == t) waiting++;
+            }
+            if (waiting >= due) continue;
+        }
+        next = t;
+        break;
+    }
+    if (balance_has(cfg, MLQ_BALANCE_STEAL) || balance_has(cfg, MLQ_BALANCE_PUSH)) {
+        for (int k = 0; k < sim->cpu_count; k++) {
+            if (k == c || sim->cpus[k].ready_count < 2) continue;
+            int t = sim->cpus[k].clock > now ? sim->cpus[k].clock : now + 1;
+            if (t < next) next = t;
+        }
+    }
+    if (next < INT_MAX) return next;
+
+    // The arrivals left go elsewhere but may still leave work to balance,
+    // so look again once the last one is in
+    if (sim->admit_cursor < n) return sim->processes[sim->arrival_order[n - 1]].arrival_time + 1;
+    long long *left = sim->cpu_work;
+    memset(left, 0, sizeof(left[0]) * (size_t)sim->cpu_count);
+    for (r = 0; r < n; r++) {
+        int k = sim->hot.cpu[r];
+        if (k >= 0) left[k] += sim->processes[sim->arrival_order[r]].remaining_time;
+    }
+    long long end = now + 1;
+    for (int k = 0; k < sim->cpu_count; k++) {
+        if (left[k] > 0 && sim->cpus[k].clock + left[k] > end) end = sim->cpus[k].clock + left[k];
+    }
+    return end < INT_MAX ? (int)end : INT_MAX;
+}
+
+// The CPU with the earliest clock (lowest index on ties) steps next
+static int next_cpu(const MlqSim *sim) {
+    int best = 0;
+    for (int c = 1; c < sim->cpu_count; c++) {
+        if (sim->cpus[c].clock < sim->cpus[best].clock) best = c;
+    }
+    return best;
+}
+
+static int step(MlqSim *sim) {
+    const MlqConfig *cfg = &sim->config;
+    MlqProcess *procs = sim->processes;
+    int n = sim->process_count;
+
+    if (sim->order_dirty) {
+        if (sort_arrivals(sim, sim->admit_cursor) < 0) return 0;
+        sim->order_dirty = 0;
+    }
+
+    int c = next_cpu(sim);
+    MlqCpu *cpu = &sim->cpus[c];
+    int now = cpu->clock;
+    sim->active_cpu = c;
+    sim->steps++;
+    cpu->steps++;
+    MLQ_PROF_COUNT(MLQ_COUNT_STEPS, 1);
+
+    // Admit everything that has arrived by now, in arrival order;
+    // its waiting counter starts counting with the next step of its CPU
+    MLQ_PROF_BEGIN(MLQ_ZONE_ADMIT);
+    while (sim->admit_cursor < n) {
+        int pid = sim->arrival_order[sim->admit_cursor];
+        MlqProcess *p = &procs[pid];
+        if (p->arrival_time > now) break;
+        p->arrival_rank = sim->admit_cursor++;
+        if (p->remaining_time <= 0) continue;
+        sim->hot.level[p->arrival_rank] = p->priority;
+        p->ready_at = p->arrival_time;
+        int dest = cfg->preempt ? cut_by(sim, pid) : -1;
+        if (dest >= 0) sim->cpus[dest].cut_for = -1;
+        else dest = place(sim, pid);
+        enqueue_on(sim, dest, pid);
+        sim->ready_count++;
+        emit(sim, MLQ_EV_ARRIVE, pid, p->arrival_time, 0, p->priority, dest);
+    }
+    MLQ_PROF_END(MLQ_ZONE_ADMIT);
+
+    // Nothing ready here: steal, or sleep as one idle span until something
+    // could come this way
+    if (cpu->ready_count == 0 && balance_has(cfg, MLQ_BALANCE_STEAL)) {
+        MLQ_PROF_BEGIN(MLQ_ZONE_BALANCE);
+        steal(sim, c, now);
+        MLQ_PROF_END(MLQ_ZONE_BALANCE);
+    }
+    if (cpu->ready_count == 0) {
+        int next = idle_until(sim, c, now);
+        record_slice(sim, c, -1, now, next - now, 0);
+        cpu->clock = next;
+        sim->current_time = sim->cpus[next_cpu(sim)].clock;
+        emit(sim, MLQ_EV_IDLE, -1, now, next - now, 0, c);
+        return 0;
+    }
+
+    const MlqPolicy *policy = sim->policy;
+    MLQ_PROF_BEGIN(MLQ_ZONE_DISPATCH);
+    int i = policy->pick_next(sim, c, now);
+    MlqProcess *p = &procs[i];
+    int priority = p->priority;
+
+    int slice = policy->slice(sim, c, i);
+    if (slice < 1) slice = 1;
+    int exec_time = (slice < p->remaining_time) ? slice : p->remaining_time;
+    int preempted = 0;
+    if (cfg->preempt) {
+        int cut = preemption_point(sim, c, priority, now + exec_time);
+        preempted = cut < now + exec_time;
+        exec_time = cut - now;
+    }
+
+    record_slice(sim, c, i, now, exec_time, priority);
+
+    p->remaining_time -= exec_time;
+    p->time_executing += exec_time;
+    sim->hot.waited[p->arrival_rank] = 0;
+    cpu->clock = now + exec_time;
+    cpu->busy_time += exec_time;
+    cpu->dispatches++;
+    p->ready_at = cpu->clock;
+
+    if (!p->has_started) {
+        p->response_time = now - p->arrival_time;
+        p->has_started = 1;
+    }
+
+    emit(sim, MLQ_EV_DISPATCH, i, now, exec_time, priority, c);
+    if (preempted) emit(sim, MLQ_EV_PREEMPT, i, cpu->clock, 0, priority, c);
+    policy->tick(sim, c, i, exec_time, cpu->clock);
+
+    if (p->remaining_time == 0) {
+        p->completion_time = cpu->clock;
+        p->turnaround_time = p->completion_time - p->arrival_time;
+        p->waiting_time = p->turnaround_time - p->burst_time;
+        policy->on_complete(sim, c, i);
+        sim->hot.cpu[p->arrival_rank] = -1;
+        sim->finished_count++;
+        sim->ready_count--;
+        cpu->ready_count--;
+        cpu->level_count[p->priority - 1]--;
+        if (p->completion_time > sim->makespan) sim->makespan = p->completion_time;
+        emit(sim, MLQ_EV_COMPLETE, i, cpu->clock, 0, priority, c);
+    } else {
+        MLQ_PROF_BEGIN(MLQ_ZONE_REQUEUE);
+        MLQ_PROF_COUNT(MLQ_COUNT_REQUEUE, 1);
+        if (policy->enqueue(sim, c, i, 0) < 0) sim->policy_failed = 1;
+        MLQ_PROF_END(MLQ_ZONE_REQUEUE);
+    }
+    MLQ_PROF_END(MLQ_ZONE_DISPATCH);
+
+    if (balance_has(cfg, MLQ_BALANCE_PUSH)) {
+        MLQ_PROF_BEGIN(MLQ_ZONE_BALANCE);
+        push(sim, c, cpu->clock);
+        MLQ_PROF_END(MLQ_ZONE_BALANCE);
+    }
+    sim->current_time = sim->cpus[next_cpu(sim)].clock;
+    return 1;
+}
+
+int mlq_sim_step(MlqSim *sim) {
+    MLQ_PROF_BEGIN(MLQ_ZONE_STEP);
+    int ran = step(sim);
+    MLQ_PROF_END(MLQ_ZONE_STEP);
+    return ran;
+}
+
+int mlq_sim_done(const MlqSim *sim) {
+    return sim->finished_count >= sim->process_count || sim->policy_failed;
+}
+
+void mlq_sim_run(MlqSim *sim) {
+    while (!mlq_sim_done(sim)) mlq_sim_step(sim);
+}
+
+int mlq_sim_time_in_queue(const MlqSim *sim, int pid) {
+    const MlqProcess *p = &sim->processes[pid];
+    if (p->cpu < 0 || p->remaining_time <= 0) return 0;
+    if (sim->config.eager_aging) return sim->hot.waited[p->arrival_rank];
+    if (p->wait_mark < 0) return 0;
+    return (int)(sim->cpus[p->cpu].steps - p->wait_mark);
+}
+
+void mlq_process_name(int pid, char *buf, size_t size) {
+    if (pid < 0) snprintf(buf, size, "IDLE");
+    else snprintf(buf, size, "P%d", pid + 1);
+}
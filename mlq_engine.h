@@ -0,0 +1,215 @@
+#ifndef MLQ_ENGINE_H
+#define MLQ_ENGINE_H
+
+#include <stddef.h>
+
+#include "mlq_timeline.h"
+
+#define NUM_QUEUES 3
+#define MLQ_MAX_CPUS 1024
+#define MLQ_HOT_BLOCK 16            // processes per step of the bulk aging kernel
+
+// How work moves between simulated CPUs
+typedef enum {
+    MLQ_BALANCE_NONE,       // a process stays on the CPU it was placed on
+    MLQ_BALANCE_PUSH,       // an overloaded CPU pushes work to the least loaded one
+    MLQ_BALANCE_STEAL,      // an idle CPU steals from the busiest one
+    MLQ_BALANCE_BOTH
+} MlqBalance;
+
+// Which scheduler orders each CPU's run queue; see mlq_policy.h
+typedef enum {
+    MLQ_POLICY_MLQ,         // multi-level queues with aging and priority decrease
+    MLQ_POLICY_CFS,         // weighted fair share on virtual runtime
+    MLQ_POLICY_EDF,         // earliest deadline first
+    MLQ_POLICY_STRIDE,      // deterministic proportional share by tickets
+    MLQ_POLICY_COUNT
+} MlqPolicyKind;
+
+// Scheduler parameters (what the GTK entries used to set globally)
+typedef struct {
+    int aging_threshold;
+    int decrease_threshold;
+    int time_quantum[NUM_QUEUES];
+    int record_timeline;
+    size_t timeline_budget;     // resident timeline bytes before spilling, 0 = unlimited
+    const char *timeline_path;  // spill file, NULL for a temporary file
+    int eager_aging;        // per-step counter scan instead of deadlines (reference)
+    int num_cpus;
+    MlqBalance balance;
+    int pin_affinity;       // pin each process to CPU pid % num_cpus, no migration
+    MlqPolicyKind policy;
+    int preempt;            // cut a slice at a higher-level arrival or the runner's promotion
+} MlqConfig;
+
+typedef struct {
+    int arrival_time;
+    int burst_time;
+    int remaining_time;
+    int priority;
+    int original_priority;
+    int time_executing;
+    int completion_time;
+    int turnaround_time;
+    int waiting_time;
+    int response_time;
+    int has_started;
+    int queue_next;         // intrusive run-queue links, -1 terminated
+    int queue_prev;
+    int arrival_rank;       // index in arrival_order and the hot table, demotion tie-break
+    long long wait_mark;    // step at which the waiting counter was last 0, -1 before admission
+    long long demote_at;    // step of the pending demotion, -1 if none
+    int cpu;                // run queue it sits on, -1 before admission
+    int ready_at;           // time it may run elsewhere (end of its last slice)
+
+    // Ordered run queues (every policy but MLQ)
+    long long sched_key;    // vruntime, absolute deadline or stride pass; ties go to the lower pid
+    int tree_left;          // AVL links, -1 terminated
+    int tree_right;
+    int tree_height;
+    int heap_index;         // slot in the CPU's heap, -1 if not on it
+} MlqProcess;
+
+typedef enum {
+    MLQ_EV_DISPATCH,
+    MLQ_EV_PROMOTE,
+    MLQ_EV_DEMOTE,
+    MLQ_EV_COMPLETE,
+    MLQ_EV_IDLE,
+    MLQ_EV_MIGRATE,
+    MLQ_EV_ARRIVE,          // admitted at its arrival time; cpu is where it was placed
+    MLQ_EV_PREEMPT          // its slice was cut short by a higher-level arrival
+} MlqEventKind;
+
+// State change reported to the front end; the engine never formats text
+typedef struct {
+    MlqEventKind kind;
+    int pid;
+    int time;
+    int duration;
+    int queue_level;
+    int cpu;                // for MLQ_EV_MIGRATE, the destination
+} MlqEvent;
+
+typedef void (*MlqEventFn)(const MlqEvent *ev, void *user);
+
+// Pending demotion in the deadline heap, ordered by (step, rank).
+// Entries whose step no longer matches the process's demote_at are stale.
+typedef struct {
+    long long step;
+    int rank;
+    int pid;
+} MlqDeadline;
+
+// One simulated CPU: its own MLQ run queues, clock and aging heap.
+// Waiting is counted in this CPU's steps.
+typedef struct {
+    int clock;              // local time; the CPU is busy until then
+    long long steps;
+    int ready_count;        // processes on this CPU's run queues
+    int level_count[NUM_QUEUES];    // of those, per level; the running one included
+    int queue_head[NUM_QUEUES];
+    int queue_tail[NUM_QUEUES];
+
+    MlqDeadline *deadlines;
+    int deadline_count;
+    int deadline_capacity;
+
+    // Ordered run queue of the other policies: an AVL tree or a binary
+    // heap of pids, both ordered by (sched_key, pid)
+    int tree_root;
+    int *heap;
+    int heap_count;
+    int heap_capacity;
+    long long vclock;       // key of the latest pick, never decreasing; wakeups start here
+    long long weight;       // total weight of the queued processes
+
+    long long busy_time;
+    long long dispatches;
+    long long migrations_in;
+    int cut_for;            // arrival that cut the latest slice and is placed here, -1 if none
+} MlqCpu;
+
+// Hot per-process state of the bulk aging pass as dense int arrays, indexed
+// by arrival rank so the admitted processes are one contiguous prefix.
+// 32-byte aligned and padded to a whole MLQ_HOT_BLOCK; padding is never
+// queued.
+typedef struct {
+    int *waited;            // steps waited since last run or level change (eager aging)
+    int *cpu;               // CPU of a queued process, -1 before admission and once finished
+    int *level;             // current priority
+    int capacity;
+} MlqHotTable;
+
+// Simulator context; everything the old globals held, one per run
+typedef struct {
+    MlqConfig config;
+
+    MlqProcess *processes;
+    int process_count;
+    int process_capacity;
+    int finished_count;
+    int ready_count;        // arrived and unfinished, over all CPUs
+
+    int *arrival_order;     // pids sorted by (arrival_time, pid)
+    int admit_cursor;       // arrival_order[0..admit_cursor) are admitted
+    int order_dirty;        // arrival_order[admit_cursor..) needs sorting
+    MlqHotTable hot;
+
+    MlqCpu *cpus;
+    int cpu_count;
+    long long *cpu_work;    // per-CPU scratch for an idle step, cpu_count long
+
+    int current_time;       // global frontier: the earliest CPU clock
+    int makespan;           // latest completion so far
+    long long steps;        // over all CPUs
+    int active_cpu;         // CPU making the current decision
+
+    const struct MlqPolicy *policy;
+    int policy_failed;      // a run queue could not grow; the run stops
+
+    MlqTimeline timeline;
+    int timeline_failed;        // an append or spill write failed
+
+    MlqEventFn on_event;
+    void *event_user;
+} MlqSim;
+
+void mlq_config_default(MlqConfig *cfg);
+
+int mlq_sim_init(MlqSim *sim, const MlqConfig *cfg);
+void mlq_sim_free(MlqSim *sim);
+
+// Drop every process; capacity is kept for the next workload
+void mlq_sim_clear_processes(MlqSim *sim);
+int mlq_sim_reserve(MlqSim *sim, int capacity);
+
+// Returns the new process id, or -1 on allocation failure
+int mlq_sim_add_process(MlqSim *sim, int arrival_time, int burst_time, int priority);
+void mlq_sim_add_default_processes(MlqSim *sim);
+
+// Rewind to time 0 keeping the workload (arrival, burst, original priority).
+// Also applies a changed num_cpus and policy; returns -1 if the CPUs can't
+// be allocated.
+int mlq_sim_reset(MlqSim *sim);
+
+// Back to the state before admission; arrival, burst and original
+// priority are kept
+void mlq_process_reset(MlqProcess *p);
+
+// One scheduling decision on the CPU with the earliest clock; returns 1 if
+// a process ran, 0 if that CPU idled. An idle step sleeps as one slice
+// until an arrival or a balancing move could give it work. The policy picks the process and its
+// slice; under MLQ each level is a FIFO whose head runs and goes back to
+// the tail (round robin).
+int mlq_sim_step(MlqSim *sim);
+void mlq_sim_run(MlqSim *sim);
+// All processes finished, or the run stopped on policy_failed
+int mlq_sim_done(const MlqSim *sim);
+
+// Steps the process has waited since it last ran or changed level
+int mlq_sim_time_in_queue(const MlqSim *sim, int pid);
+
+void mlq_process_name(int pid, char *buf, size_t size);
+
+#endif
@@ -0,0 +1,294 @@
+#include "mlq_history.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void mlq_history_init(MlqHistory *h, size_t memory_budget) {
+    memset(h, 0, sizeof(*h));
+    h->memory_budget = memory_budget;
+    h->interval = MLQ_HISTORY_INTERVAL;
+}
+
+static void snapshot_free(MlqSnapshot *s, int cpu_count) {
+    if (s->cpus) {
+        for (int c = 0; c < cpu_count; c++) {
+            free(s->cpus[c].deadlines);
+            free(s->cpus[c].heap);
+        }
+    }
+    free(s->cpus);
+    free(s->live);
+}
+
+static void drop_snapshots(MlqHistory *h) {
+    for (int i = 0; i < h->count; i++) snapshot_free(&h->snapshots[i], h->cpu_count);
+    h->count = 0;
+    h->bytes = 0;
+}
+
+void mlq_history_free(MlqHistory *h) {
+    drop_snapshots(h);
+    free(h->snapshots);
+    free(h->final);
+    free(h->final_valid);
+    memset(h, 0, sizeof(*h));
+}
+
+static void schedule(MlqHistory *h) {
+    long long gap = h->interval > h->last_scan ? h->interval : h->last_scan;
+    h->due = h->snapshots[h->count - 1].steps + gap;
+}
+
+// Drop every other snapshot, keeping step 0, and space them twice as far
+static void thin(MlqHistory *h) {
+    int kept = 0;
+    for (int i = 0; i < h->count; i++) {
+        if (i % 2 == 0) {
+            h->snapshots[kept++] = h->snapshots[i];
+        } else {
+            h->bytes -= h->snapshots[i].bytes;
+            snapshot_free(&h->snapshots[i], h->cpu_count);
+        }
+    }
+    h->count = kept;
+    h->interval *= 2;
+    schedule(h);
+}
+
+// Copy a CPU with its deadline and run-queue heaps
+static int copy_cpu(MlqCpu *dst, const MlqCpu *src) {
+    *dst = *src;
+    dst->deadlines = NULL;
+    dst->heap = NULL;
+    dst->deadline_capacity = src->deadline_count;
+    dst->heap_capacity = src->heap_count;
+    if (src->deadline_count > 0) {
+        dst->deadlines = malloc(sizeof(MlqDeadline) * src->deadline_count);
+        if (!dst->deadlines) return -1;
+        memcpy(dst->deadlines, src->deadlines, sizeof(MlqDeadline) * src->deadline_count);
+    }
+    if (src->heap_count > 0) {
+        dst->heap = malloc(sizeof(int) * src->heap_count);
+        if (!dst->heap) return -1;
+        memcpy(dst->heap, src->heap, sizeof(int) * src->heap_count);
+    }
+    return 0;
+}
+
+static int take_snapshot(MlqHistory *h, const MlqSim *sim) {
+    if (h->count == h->capacity) {
+        int cap = h->capacity ? h->capacity * 2 : 16;
+        MlqSnapshot *grown = realloc(h->snapshots, sizeof(MlqSnapshot) * cap);
+        if (!grown) return -1;
+        h->snapshots = grown;
+        h->capacity = cap;
+    }
+
+    // A finished process never changes again, so it is kept once for all
+    // snapshots; only the live ones are copied each time. Snapshots are
+    // only taken moving forward, so nothing below first_live comes back.
+    int live = 0, first_live = sim->admit_cursor;
+    for (int r = h->first_live; r < sim->admit_cursor; r++) {
+        int pid = sim->arrival_order[r];
+        if (sim->processes[pid].remaining_time > 0) {
+            if (live++ == 0) first_live = r;
+        } else if (!h->final_valid[pid]) {
+            h->final[pid] = sim->processes[pid];
+            h->final_valid[pid] = 1;
+        }
+    }
+
+    MlqSnapshot *s = &h->snapshots[h->count];
+    memset(s, 0, sizeof(*s));
+    s->live = malloc(sizeof(MlqLiveRecord) * (live > 0 ? live : 1));
+    s->cpus = calloc((size_t)sim->cpu_count, sizeof(MlqCpu));
+    if (!s->live || !s->cpus) {
+        snapshot_free(s, 0);
+        return -1;
+    }
+    s->bytes = sizeof(MlqSnapshot) + sizeof(MlqLiveRecord) * live + sizeof(MlqCpu) * sim->cpu_count;
+    for (int c = 0; c < sim->cpu_count; c++) {
+        if (copy_cpu(&s->cpus[c], &sim->cpus[c]) < 0) {
+            snapshot_free(s, sim->cpu_count);
+            return -1;
+        }
+        s->bytes += sizeof(MlqDeadline) * s->cpus[c].deadline_count + sizeof(int) * s->cpus[c].heap_count;
+    }
+    for (int r = first_live; r < sim->admit_cursor; r++) {
+        int pid = sim->arrival_order[r];
+        if (sim->processes[pid].remaining_time <= 0) continue;
+        MlqLiveRecord *rec = &s->live[s->live_count++];
+        rec->pid = pid;
+        rec->waited = sim->hot.waited[r];
+        rec->state = sim->processes[pid];
+    }
+
+    s->steps = sim->steps;
+    s->current_time = sim->current_time;
+    s->makespan = sim->makespan;
+    s->finished_count = sim->finished_count;
+    s->ready_count = sim->ready_count;
+    s->admit_cursor = sim->admit_cursor;
+    s->order_dirty = sim->order_dirty;
+    s->active_cpu = sim->active_cpu;
+    s->policy_failed = sim->policy_failed;
+
+    h->count++;
+    h->bytes += s->bytes;
+    h->last_scan = sim->admit_cursor - h->first_live;
+    h->first_live = first_live;
+    schedule(h);
+    while (h->memory_budget > 0 && h->bytes > h->memory_budget && h->count > 1) thin(h);
+    return 0;
+}
+
+static int restore(MlqHistory *h, MlqSim *sim, const MlqSnapshot *s) {
+    if (sim->process_count != h->process_count || sim->cpu_count != h->cpu_count) return -1;
+
+    // Room for the run queues first, so a failure leaves the state as it was
+    for (int c = 0; c < sim->cpu_count; c++) {
+        MlqCpu *cpu = &sim->cpus[c];
+        const MlqCpu *src = &s->cpus[c];
+        if (src->deadline_count > cpu->deadline_capacity) {
+            MlqDeadline *grown = realloc(cpu->deadlines, sizeof(MlqDeadline) * src->deadline_count);
+            if (!grown) return -1;
+            cpu->deadlines = grown;
+            cpu->deadline_capacity = src->deadline_count;
+        }
+        if (src->heap_count > cpu->heap_capacity) {
+            int *grown = realloc(cpu->heap, sizeof(int) * src->heap_count);
+            if (!grown) return -1;
+            cpu->heap = grown;
+            cpu->heap_capacity = src->heap_count;
+        }
+    }
+
+    // Processes admitted after the snapshot go back to their reset state.
+    // Those admitted before it were either finished then, and take their
+    // final record, or are listed live; one already finished now is
+    // final already.
+    MlqHotTable *hot = &sim->hot;
+    int cursor = sim->admit_cursor > s->admit_cursor ? sim->admit_cursor : s->admit_cursor;
+    for (int r = 0; r < cursor; r++) {
+        int pid = sim->arrival_order[r];
+        MlqProcess *p = &sim->processes[pid];
+        if (r >= s->admit_cursor) {
+            mlq_process_reset(p);
+            hot->waited[r] = 0;
+            hot->cpu[r] = -1;
+            hot->level[r] = 0;
+        } else if ((r >= sim->admit_cursor || p->remaining_time > 0) && h->final_valid[pid]) {
+            *p = h->final[pid];
+            hot->waited[r] = 0;
+            hot->cpu[r] = -1;
+            hot->level[r] = p->priority;
+        }
+    }
+    for (int i = 0; i < s->live_count; i++) {
+        const MlqLiveRecord *rec = &s->live[i];
+        MlqProcess *p = &sim->processes[rec->pid];
+        *p = rec->state;
+        hot->waited[p->arrival_rank] = rec->waited;
+        hot->cpu[p->arrival_rank] = p->cpu;
+        hot->level[p->arrival_rank] = p->priority;
+    }
+
+    for (int c = 0; c < sim->cpu_count; c++) {
+        MlqCpu *cpu = &sim->cpus[c];
+        const MlqCpu *src = &s->cpus[c];
+        MlqDeadline *deadlines = cpu->deadlines;
+        int deadline_capacity = cpu->deadline_capacity;
+        int *heap = cpu->heap;
+        int heap_capacity = cpu->heap_capacity;
+        *cpu = *src;
+        cpu->deadlines = deadlines;
+        cpu->deadline_capacity = deadline_capacity;
+        cpu->heap = heap;
+        cpu->heap_capacity = heap_capacity;
+        if (src->deadline_count > 0) memcpy(deadlines, src->deadlines, sizeof(MlqDeadline) * src->deadline_count);
+        if (src->heap_count > 0) memcpy(heap, src->heap, sizeof(int) * src->heap_count);
+    }
+
+    sim->steps = s->steps;
+    sim->current_time = s->current_time;
+    sim->makespan = s->makespan;
+    sim->finished_count = s->finished_count;
+    sim->ready_count = s->ready_count;
+    sim->admit_cursor = s->admit_cursor;
+    sim->order_dirty = sim->order_dirty || s->order_dirty;
+    sim->active_cpu = s->active_cpu;
+    sim->policy_failed = s->policy_failed;
+    return 0;
+}
+
+int mlq_history_reset(MlqHistory *h, const MlqSim *sim) {
+    drop_snapshots(h);
+    h->interval = MLQ_HISTORY_INTERVAL;
+    h->first_live = 0;
+    h->last_scan = 0;
+    h->process_count = 0;
+    h->cpu_count = sim->cpu_count;
+
+    size_t n = sim->process_count > 0 ? (size_t)sim->process_count : 1;
+    MlqProcess *final = realloc(h->final, sizeof(MlqProcess) * n);
+    if (!final) return -1;
+    h->final = final;
+    unsigned char *valid = realloc(h->final_valid, n);
+    if (!valid) return -1;
+    h->final_valid = valid;
+    memset(valid, 0, n);
+    h->process_count = sim->process_count;
+    return take_snapshot(h, sim);
+}
+
+int mlq_history_step(MlqHistory *h, MlqSim *sim) {
+    int ran = mlq_sim_step(sim);
+    if (h->count > 0 && sim->steps >= h->due && take_snapshot(h, sim) < 0) {
+        // Out of memory: make room and try again an interval later
+        if (h->count > 1) thin(h);
+        else h->due = sim->steps + h->interval;
+    }
+    return ran;
+}
+
+// Step forward until `steps` decisions or `time` is reached
+static void replay(MlqHistory *h, MlqSim *sim, long long steps, int time) {
+    while (sim->steps < steps && sim->current_time < time && !mlq_sim_done(sim)) {
+        long long before = sim->steps;
+        mlq_history_step(h, sim);
+        if (sim->steps == before) break;        // arrivals couldn't be sorted
+    }
+}
+
+int mlq_history_seek(MlqHistory *h, MlqSim *sim, long long steps) {
+    if (h->count == 0) return -1;
+    if (steps < 0) steps = 0;
+
+    // Latest snapshot at or before the target
+    int lo = 0, hi = h->count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (h->snapshots[mid].steps <= steps) lo = mid;
+        else hi = mid - 1;
+    }
+    const MlqSnapshot *s = &h->snapshots[lo];
+    if ((sim->steps > steps || sim->steps < s->steps) && restore(h, sim, s) < 0) return -1;
+    replay(h, sim, steps, 0x7fffffff);
+    return 0;
+}
+
+int mlq_history_seek_time(MlqHistory *h, MlqSim *sim, int time) {
+    if (h->count == 0) return -1;
+
+    // Latest snapshot still short of the target; the clock never goes back
+    int lo = 0, hi = h->count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (h->snapshots[mid].current_time < time) lo = mid;
+        else hi = mid - 1;
+    }
+    const MlqSnapshot *s = &h->snapshots[lo];
+    if ((sim->current_time >= time || sim->steps < s->steps) && restore(h, sim, s) < 0) return -1;
+    replay(h, sim, 0x7fffffffffffffffLL, time);
+    return 0;
+}
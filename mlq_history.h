@@ -0,0 +1,81 @@
+#ifndef MLQ_HISTORY_H
+#define MLQ_HISTORY_H
+
+#include <stddef.h>
+
+#include "mlq_engine.h"
+
+#define MLQ_HISTORY_INTERVAL 4096       // steps between snapshots before any thinning
+
+// Scheduler state of one admitted, unfinished process
+typedef struct {
+    int pid;
+    int waited;                 // its hot-table counter
+    MlqProcess state;
+} MlqLiveRecord;
+
+// Everything needed to put the engine back at one step. Only live
+// processes are stored; finished ones come from the history's final
+// records and unadmitted ones are in their reset state.
+typedef struct {
+    long long steps;
+    int current_time;
+    int makespan;
+    int finished_count;
+    int ready_count;
+    int admit_cursor;
+    int order_dirty;
+    int active_cpu;
+    int policy_failed;
+
+    MlqCpu *cpus;               // copies; deadlines and heap point at owned arrays
+    MlqLiveRecord *live;
+    int live_count;
+    size_t bytes;
+} MlqSnapshot;
+
+// Periodic snapshots of one run. The engine is deterministic, so the
+// steps between two snapshots are their own journal: any state is the
+// nearest earlier snapshot plus a replay. Snapshots are at least as far
+// apart as the ranks they walk, so taking them costs about one process
+// copy per step. When they outgrow the memory budget every other one is
+// dropped and the interval doubles, so a seek replays at most about
+// interval steps. Only scheduler state is
+// kept: the engine's own timeline is not rewound, so a front end that
+// seeks backward records its chart from events, as the viewer does.
+typedef struct {
+    MlqSnapshot *snapshots;     // ordered by step; [0] is step 0
+    int count;
+    int capacity;
+    long long interval;
+    long long due;              // step of the next snapshot
+    int first_live;             // ranks below it had all finished at the last snapshot
+    int last_scan;              // ranks the last snapshot walked
+    size_t memory_budget;       // bytes of snapshots, 0 = unlimited
+    size_t bytes;
+
+    MlqProcess *final;          // state of each process once finished, by pid
+    unsigned char *final_valid;
+    int process_count;          // workload size the history was taken over
+    int cpu_count;
+} MlqHistory;
+
+void mlq_history_init(MlqHistory *h, size_t memory_budget);
+void mlq_history_free(MlqHistory *h);
+
+// Start over from a freshly reset simulator; takes the step 0 snapshot
+int mlq_history_reset(MlqHistory *h, const MlqSim *sim);
+
+// mlq_sim_step, then a snapshot when one is due. A snapshot that can't be
+// allocated is skipped; seeks then replay from the one before.
+int mlq_history_step(MlqHistory *h, MlqSim *sim);
+
+// Put the simulator at `steps` decisions (or where it finishes). Restores
+// the nearest snapshot unless the current state is already closer.
+// Returns -1 if the workload or CPU count changed since the reset.
+int mlq_history_seek(MlqHistory *h, MlqSim *sim, long long steps);
+
+// The first state whose current_time is at least `time`
+int mlq_history_seek_time(MlqHistory *h, MlqSim *sim, int time);
+
+#endif
@@ -0,0 +1,542 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_import.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define READ_BLOCK (1 << 20)            // bytes read from the capture at a time
+#define DEFAULT_INTERVAL_US 10000
+
+// Lines of a capture, read in blocks so pipes work and memory stays flat
+typedef struct {
+    FILE *file;
+    char *buf;
+    size_t size;
+    size_t len;
+    size_t pos;
+    int eof;
+} LineReader;
+
+static int reader_open(LineReader *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    r->file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!r->file) return -1;
+    r->size = READ_BLOCK;
+    r->buf = malloc(r->size);
+    if (!r->buf) {
+        if (r->file != stdin) fclose(r->file);
+        return -1;
+    }
+    return 0;
+}
+
+static void reader_close(LineReader *r) {
+    if (r->file && r->file != stdin) fclose(r->file);
+    free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+// Next line without its newline; 0 at the end, -1 if a line can't fit
+static int next_line(LineReader *r, const char **line, const char **end) {
+    for (;;) {
+        char *nl = memchr(r->buf + r->pos, '\n', r->len - r->pos);
+        if (nl) {
+            *line = r->buf + r->pos;
+            *end = nl;
+            r->pos = (size_t)(nl - r->buf) + 1;
+            return 1;
+        }
+        if (r->eof) {
+            if (r->pos == r->len) return 0;
+            *line = r->buf + r->pos;
+            *end = r->buf + r->len;
+            r->pos = r->len;
+            return 1;
+        }
+        // Keep the partial line, growing the buffer for an overlong one
+        memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+        r->len -= r->pos;
+        r->pos = 0;
+        if (r->len == r->size) {
+            char *grown = realloc(r->buf, r->size * 2);
+            if (!grown) return -1;
+            r->buf = grown;
+            r->size *= 2;
+        }
+        size_t n = fread(r->buf + r->len, 1, r->size - r->len, r->file);
+        r->len += n;
+        if (n == 0) r->eof = 1;
+    }
+}
+
+// Per-task state, open-addressed on tid
+typedef struct {
+    int key;                    // tid + 1; 0 marks a free slot
+    int level;
+    int open;                   // perf: a burst is open
+    long long start;            // perf: ns the burst became runnable
+    long long on_cpu;           // perf: ns it was switched in, -1 if off
+    long long run;              // perf: ns run in the burst; sampler: schedstat run_ns
+    long long wait;             // sampler: schedstat wait_ns
+    long long slices;           // sampler: schedstat timeslices
+} TaskState;
+
+typedef struct {
+    TaskState *slots;
+    int capacity;               // a power of two
+    int count;
+} TaskTable;
+
+static void table_free(TaskTable *t) {
+    free(t->slots);
+    memset(t, 0, sizeof(*t));
+}
+
+static TaskState *table_probe(TaskState *slots, int capacity, int key) {
+    unsigned i = ((unsigned)key * 2654435761u) & (unsigned)(capacity - 1);
+    while (slots[i].key != 0 && slots[i].key != key) i = (i + 1) & (unsigned)(capacity - 1);
+    return &slots[i];
+}
+
+static TaskState *table_find(TaskTable *t, int tid) {
+    if (t->count == 0) return NULL;
+    TaskState *s = table_probe(t->slots, t->capacity, tid + 1);
+    return s->key != 0 ? s : NULL;
+}
+
+// Linear probing: pull later entries of the run back into the hole so
+// lookups still find them
+static void table_remove(TaskTable *t, TaskState *s) {
+    unsigned mask = (unsigned)(t->capacity - 1);
+    unsigned hole = (unsigned)(s - t->slots);
+    for (unsigned i = (hole + 1) & mask; t->slots[i].key != 0; i = (i + 1) & mask) {
+        unsigned home = ((unsigned)t->slots[i].key * 2654435761u) & mask;
+        // Movable unless its home lies cyclically in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            t->slots[hole] = t->slots[i];
+            hole = i;
+        }
+    }
+    t->slots[hole].key = 0;
+    t->count--;
+}
+
+// The task's state, zeroed if new; NULL when out of memory
+static TaskState *table_insert(TaskTable *t, int tid, int *created) {
+    if (2 * (t->count + 1) > t->capacity) {
+        int cap = t->capacity ? t->capacity * 2 : 4096;
+        TaskState *slots = calloc((size_t)cap, sizeof(TaskState));
+        if (!slots) return NULL;
+        for (int i = 0; i < t->capacity; i++) {
+            if (t->slots[i].key != 0) *table_probe(slots, cap, t->slots[i].key) = t->slots[i];
+        }
+        free(t->slots);
+        t->slots = slots;
+        t->capacity = cap;
+    }
+    TaskState *s = table_probe(t->slots, t->capacity, tid + 1);
+    *created = s->key == 0;
+    if (*created) {
+        memset(s, 0, sizeof(*s));
+        s->key = tid + 1;
+        s->on_cpu = -1;
+        t->count++;
+    }
+    return s;
+}
+
+int mlq_nice_to_level(int nice) {
+    if (nice < -20) nice = -20;
+    if (nice > 19) nice = 19;
+    return 1 + (nice + 20) * NUM_QUEUES / 40;
+}
+
+// Kernel priority as perf prints it: below 100 is real-time, then 120 + nice
+static int prio_to_level(long long prio) {
+    return prio < 100 ? 1 : mlq_nice_to_level((int)(prio - 120));
+}
+
+static const char *find(const char *p, const char *end, const char *needle) {
+    size_t n = strlen(needle);
+    for (; p + n <= end; p++) {
+        if (*p == *needle && memcmp(p, needle, n) == 0) return p;
+    }
+    return NULL;
+}
+
+static const char *parse_int(const char *p, const char *end, long long *out) {
+    int negative = p < end && *p == '-';
+    if (negative) p++;
+    if (p >= end || *p < '0' || *p > '9') return NULL;
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9' && v < LLONG_MAX / 10) v = v * 10 + (*p++ - '0');
+    *out = negative ? -v : v;
+    return p;
+}
+
+// Integer after `key` (which ends in '=') in [p, end)
+static int key_int(const char *p, const char *end, const char *key, long long *out) {
+    const char *at = find(p, end, key);
+    return at && parse_int(at + strlen(key), end, out) ? 0 : -1;
+}
+
+// "comm:pid [prio]" with the comm free to hold anything but '['; *after
+// is just past the ']'
+static int parse_compact_task(const char *p, const char *end, long long *pid, long long *prio, const char **after) {
+    const char *open = memchr(p, '[', (size_t)(end - p));
+    if (!open) return -1;
+    const char *q = open;
+    while (q > p && q[-1] == ' ') q--;
+    const char *digits = q;
+    while (digits > p && digits[-1] >= '0' && digits[-1] <= '9') digits--;
+    if (digits == q || !parse_int(digits, q, pid)) return -1;
+    const char *close = parse_int(open + 1, end, prio);
+    if (!close || close >= end || *close != ']') return -1;
+    *after = close + 1;
+    return 0;
+}
+
+// "1234.567890:" before the event name, to nanoseconds
+static int parse_timestamp(const char *line, const char *event, long long *ns) {
+    const char *q = event;
+    while (q > line && (q[-1] == ' ' || q[-1] == ':')) q--;
+    const char *start = q;
+    while (start > line && ((start[-1] >= '0' && start[-1] <= '9') || start[-1] == '.')) start--;
+    long long secs;
+    const char *dot = parse_int(start, q, &secs);
+    if (!dot || dot >= q || *dot != '.') return -1;
+    long long frac = 0, scale = 1000000000;
+    for (const char *d = dot + 1; d < q && scale > 1; d++) {
+        frac = frac * 10 + (*d - '0');
+        scale /= 10;
+    }
+    *ns = secs * 1000000000 + frac * scale;
+    return 0;
+}
+
+typedef struct {
+    MlqWorkload *wl;
+    MlqImportStats *stats;
+    long long tick_ns;
+    long long origin;           // ns of tick 0, -1 until the first event
+    int overflow;
+} Importer;
+
+static int emit_job(Importer *im, long long arrival_ns, long long run_ns, int level) {
+    if (run_ns <= 0) return 0;
+    long long arrival = (arrival_ns - im->origin) / im->tick_ns;
+    long long burst = (run_ns + im->tick_ns - 1) / im->tick_ns;
+    if (arrival < 0) arrival = 0;
+    if (arrival > INT_MAX || burst > INT_MAX) {
+        im->overflow = 1;
+        return -1;
+    }
+    if (mlq_workload_push(im->wl, (int)arrival, (int)burst, level) < 0) return -1;
+    im->stats->jobs++;
+    return 0;
+}
+
+// Close the task's burst if it has run; a fresh one opens on its next wakeup
+static int close_burst(Importer *im, TaskState *s) {
+    int status = s->open ? emit_job(im, s->start, s->run, s->level) : 0;
+    s->open = 0;
+    s->run = 0;
+    return status;
+}
+
+static void open_burst(TaskState *s, long long t) {
+    if (s->open) return;
+    s->open = 1;
+    s->start = t;
+    s->run = 0;
+}
+
+static TaskState *task(Importer *im, TaskTable *tasks, long long tid, long long prio) {
+    int created;
+    TaskState *s = table_insert(tasks, (int)tid, &created);
+    if (!s) return NULL;
+    if (created) im->stats->tasks++;
+    s->level = prio_to_level(prio);
+    return s;
+}
+
+// One perf sched script line: 0 done, 1 not a scheduler event, -1 failed
+static int perf_line(Importer *im, TaskTable *tasks, const char *line, const char *end, long long *last) {
+    const char *event = find(line, end, "sched:sched_");
+    if (!event) return 1;
+    const char *name = event + strlen("sched:sched_");
+    int is_switch = end - name >= 7 && memcmp(name, "switch:", 7) == 0;
+    int is_wakeup = end - name >= 6 && find(name, end, ":") &&
+                    (memcmp(name, "wakeup", 6) == 0 || memcmp(name, "waking", 6) == 0);
+    if (!is_switch && !is_wakeup) return 1;
+
+    long long t;
+    if (parse_timestamp(line, event, &t) < 0) return 1;
+    if (im->origin < 0) im->origin = t;
+    *last = t;
+    const char *fields = memchr(name, ':', (size_t)(end - name)) + 1;
+
+    if (is_wakeup) {
+        long long pid, prio;
+        const char *after;
+        if (key_int(fields, end, " pid=", &pid) < 0 || key_int(fields, end, "prio=", &prio) < 0) {
+            if (parse_compact_task(fields, end, &pid, &prio, &after) < 0) return 1;
+        }
+        if (pid <= 0 || pid > INT_MAX - 1) return 0;
+        TaskState *s = task(im, tasks, pid, prio);
+        if (!s) return -1;
+        open_burst(s, t);
+        im->stats->events++;
+        return 0;
+    }
+
+    long long prev_pid, prev_prio, next_pid, next_prio;
+    const char *state, *state_end;
+    const char *arrow = find(fields, end, "==>");
+    if (!arrow) return 1;
+    if (key_int(fields, arrow, "prev_pid=", &prev_pid) == 0) {
+        if (key_int(fields, arrow, "prev_prio=", &prev_prio) < 0 || key_int(arrow, end, "next_pid=", &next_pid) < 0 ||
+            key_int(arrow, end, "next_prio=", &next_prio) < 0) {
+            return 1;
+        }
+        state = find(fields, arrow, "prev_state=");
+        if (!state) return 1;
+        state += strlen("prev_state=");
+    } else {
+        const char *after;
+        if (parse_compact_task(fields, arrow, &prev_pid, &prev_prio, &state) < 0 ||
+            parse_compact_task(arrow + 3, end, &next_pid, &next_prio, &after) < 0) {
+            return 1;
+        }
+        while (state < arrow && *state == ' ') state++;
+    }
+    state_end = state;
+    while (state_end < arrow && *state_end != ' ') state_end++;
+    if (prev_pid > INT_MAX - 1 || next_pid > INT_MAX - 1) return 0;
+
+    // Only tasks seen since the capture started have a burst to close
+    TaskState *prev = prev_pid > 0 ? table_find(tasks, (int)prev_pid) : NULL;
+    if (prev) {
+        if (prev->on_cpu >= 0) prev->run += t - prev->on_cpu;
+        prev->on_cpu = -1;
+        prev->level = prio_to_level(prev_prio);
+        // Preempted (R, R+) tasks stay runnable; anything else ends the burst
+        if ((state == state_end || *state != 'R') && close_burst(im, prev) < 0) return -1;
+        // A dead (X) or zombie (Z) task is gone; its tid may come back
+        if (state < state_end && (*state == 'X' || *state == 'Z')) table_remove(tasks, prev);
+    }
+    if (next_pid > 0) {
+        TaskState *next = task(im, tasks, next_pid, next_prio);
+        if (!next) return -1;
+        open_burst(next, t);
+        next->on_cpu = t;
+    }
+    im->stats->events++;
+    return 0;
+}
+
+// One sample: "t_us tid nice run_ns wait_ns timeslices"; 1 if malformed
+static int proc_line(Importer *im, const char *line, const char *end, long long interval_ns) {
+    long long v[6];
+    const char *p = line;
+    for (int f = 0; f < 6; f++) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        if (!(p = parse_int(p, end, &v[f]))) return 1;
+    }
+    long long t = v[0] * 1000, run = v[3], queued = v[3] + v[4];
+    if (im->origin < 0) im->origin = t - interval_ns;
+    im->stats->events++;
+    long long arrival = t - (queued < interval_ns ? queued : interval_ns);
+    return emit_job(im, arrival, run, mlq_nice_to_level((int)v[2])) < 0 ? -1 : 0;
+}
+
+int mlq_workload_import(MlqWorkload *wl, const char *path, int tick_us, MlqImportStats *stats) {
+    LineReader r;
+    if (tick_us < 1) {
+        fprintf(stderr, "import tick must be at least 1 us\n");
+        return -1;
+    }
+    if (reader_open(&r, path) < 0) {
+        perror(path);
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->format = MLQ_IMPORT_PERF_SCHED;
+    Importer im = {wl, stats, (long long)tick_us * 1000, -1, 0};
+    TaskTable tasks = {NULL, 0, 0};
+    long long interval_ns = (long long)DEFAULT_INTERVAL_US * 1000;
+    long long last = 0;
+    const char *line, *end;
+    int rc, status = 0;
+    while (status == 0 && (rc = next_line(&r, &line, &end)) > 0) {
+        stats->lines++;
+        if (end > line && end[-1] == '\r') end--;
+        if (stats->lines == 1 && end - line >= (long)strlen(MLQ_PROC_SAMPLES_MAGIC) &&
+            memcmp(line, MLQ_PROC_SAMPLES_MAGIC, strlen(MLQ_PROC_SAMPLES_MAGIC)) == 0) {
+            stats->format = MLQ_IMPORT_PROC_SAMPLES;
+            long long us;
+            if (key_int(line, end, "interval_us=", &us) == 0 && us > 0) interval_ns = us * 1000;
+            continue;
+        }
+        const char *p = line;
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        if (p == end || *p == '#') continue;
+
+        int result = stats->format == MLQ_IMPORT_PROC_SAMPLES ? proc_line(&im, p, end, interval_ns)
+                                                              : perf_line(&im, &tasks, p, end, &last);
+        if (result > 0) stats->unparsed++;
+        else if (result < 0) status = -1;
+    }
+    if (rc < 0) status = -1;
+
+    // Bursts still open at the end of the capture
+    for (int i = 0; status == 0 && i < tasks.capacity; i++) {
+        TaskState *s = &tasks.slots[i];
+        if (s->key == 0) continue;
+        if (s->on_cpu >= 0) s->run += last - s->on_cpu;
+        if (close_burst(&im, s) < 0) status = -1;
+    }
+
+    table_free(&tasks);
+    reader_close(&r);
+    if (im.overflow) fprintf(stderr, "%s: capture too long for %d us ticks; use a longer tick\n", path, tick_us);
+    else if (status < 0) fprintf(stderr, "%s: out of memory\n", path);
+    return status;
+}
+
+#ifdef __linux__
+
+static long long monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int read_small(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return (int)n;
+}
+
+static int is_number(const char *s) {
+    if (!*s) return 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') return 0;
+    }
+    return 1;
+}
+
+// Field 19 of /proc/.../stat, counted after the ")" that ends the comm
+static int read_nice(const char *dir) {
+    char path[576], buf[1024];
+    snprintf(path, sizeof(path), "%s/stat", dir);
+    if (read_small(path, buf, sizeof(buf)) < 0) return 0;
+    const char *p = strrchr(buf, ')');
+    if (!p) return 0;
+    for (int field = 2; field < 19 && p; field++) p = strchr(p + 1, ' ');
+    return p ? atoi(p + 1) : 0;
+}
+
+// One pass over every thread; writes those that ran since the last pass
+static int sample_once(FILE *out, TaskTable *tasks, long long now, int baseline) {
+    DIR *proc = opendir("/proc");
+    if (!proc) return -1;
+    struct dirent *pe;
+    while ((pe = readdir(proc)) != NULL) {
+        if (!is_number(pe->d_name)) continue;
+        char task_dir[288];
+        snprintf(task_dir, sizeof(task_dir), "/proc/%s/task", pe->d_name);
+        DIR *threads = opendir(task_dir);
+        if (!threads) continue;         // exited since readdir
+        struct dirent *te;
+        while ((te = readdir(threads)) != NULL) {
+            if (!is_number(te->d_name)) continue;
+            char dir[552], path[576], buf[128];
+            snprintf(dir, sizeof(dir), "%s/%s", task_dir, te->d_name);
+            snprintf(path, sizeof(path), "%s/schedstat", dir);
+            long long run, wait, slices;
+            if (read_small(path, buf, sizeof(buf)) < 0 || sscanf(buf, "%lld %lld %lld", &run, &wait, &slices) != 3) {
+                continue;
+            }
+
+            int created;
+            TaskState *s = table_insert(tasks, atoi(te->d_name), &created);
+            if (!s) {
+                closedir(threads);
+                closedir(proc);
+                return -1;
+            }
+            // A lower count than last time is a reused tid: a new thread
+            if (!created && run < s->run) created = 1;
+            if (created) s->run = s->wait = s->slices = 0;
+            if (!baseline && run > s->run) {
+                fprintf(out, "%lld %s %d %lld %lld %lld\n", now, te->d_name, read_nice(dir), run - s->run,
+                        wait > s->wait ? wait - s->wait : 0, slices > s->slices ? slices - s->slices : 0);
+            }
+            s->run = run;
+            s->wait = wait;
+            s->slices = slices;
+        }
+        closedir(threads);
+    }
+    closedir(proc);
+    return 0;
+}
+
+int mlq_proc_sample(const char *path, int interval_ms, double seconds) {
+    if (interval_ms < 1) interval_ms = 1;
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return -1;
+    }
+    fprintf(out, "%s interval_us=%d\n", MLQ_PROC_SAMPLES_MAGIC, interval_ms * 1000);
+    fprintf(out, "# t_us tid nice run_ns wait_ns timeslices, each a change since the last sample\n");
+
+    TaskTable tasks = {NULL, 0, 0};
+    long long start = monotonic_us(), interval = (long long)interval_ms * 1000;
+    long long stop = start + (long long)(seconds * 1e6);
+    // The first pass only records where every thread's counters stand
+    int status = sample_once(out, &tasks, start, 1);
+    for (long long next = start + interval; status == 0 && next <= stop; next += interval) {
+        long long now = monotonic_us();
+        if (next > now) {
+            struct timespec ts = {(time_t)(next / 1000000), (long)(next % 1000000) * 1000};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            now = monotonic_us();
+        } else {
+            next = now;                 // a slow pass pushes the schedule back
+        }
+        status = sample_once(out, &tasks, now, 0);
+    }
+    table_free(&tasks);
+    if (fclose(out) != 0 || status < 0) {
+        fprintf(stderr, "%s: sampling failed\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+#else
+
+int mlq_proc_sample(const char *path, int interval_ms, double seconds) {
+    fprintf(stderr, "sampling needs Linux /proc\n");
+    return -1;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef MLQ_IMPORT_H
+#define MLQ_IMPORT_H
+
+#include "mlq_workload.h"
+
+#define MLQ_PROC_SAMPLES_MAGIC "# mlq-proc-samples"
+
+typedef enum {
+    MLQ_IMPORT_PERF_SCHED,      // `perf sched script` text
+    MLQ_IMPORT_PROC_SAMPLES     // written by mlq_proc_sample
+} MlqImportFormat;
+
+typedef struct {
+    MlqImportFormat format;
+    long long lines;
+    long long events;           // scheduler events or samples used
+    long long unparsed;         // lines that matched neither format
+    long long jobs;
+    int tasks;                  // distinct tasks seen (perf)
+} MlqImportStats;
+
+// Level for a nice value: -20..19 split evenly over NUM_QUEUES, nice 0 in
+// the middle level
+int mlq_nice_to_level(int nice);
+
+// Turn a capture of real scheduling activity into jobs, appended to `wl`.
+// The format is detected from the first line. The capture is read once
+// in blocks through stdio, so it can be any size and may be a pipe ("-"
+// is stdin); memory grows only with the jobs and the tasks alive at once.
+//
+// perf sched script: a job is one CPU burst. It arrives when the task is
+// woken (or first switched in), and its burst is the time it ran until it
+// switched out in any state but R. A preempted task stays runnable and
+// keeps adding to the same burst. The level comes from the kernel
+// priority, and real-time tasks go to level 1. A task is forgotten once
+// it switches out dead (X) or as a zombie (Z).
+//
+// Proc samples: a job is the CPU time a thread used in one sample
+// interval. It arrives at the interval's end less its run and queue time.
+//
+// Times are counted from the first event in ticks of tick_us
+// microseconds, and bursts round up to at least one tick.
+int mlq_workload_import(MlqWorkload *wl, const char *path, int tick_us, MlqImportStats *stats);
+
+// Linux only: poll /proc/<pid>/task/<tid>/{stat,schedstat} every
+// interval_ms for `seconds` and write each thread's CPU time per
+// interval to `path` for mlq_workload_import. Threads that did not run
+// are left out. Returns -1 where there is no /proc.
+int mlq_proc_sample(const char *path, int interval_ms, double seconds);
+
+#endif
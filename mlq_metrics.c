@@ -0,0 +1,227 @@
+#include "mlq_metrics.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SUB_COUNT (1 << MLQ_HIST_SUB_BITS)
+
+static int highest_bit(unsigned v) {
+#ifdef __GNUC__
+    return 31 - __builtin_clz(v);
+#else
+    int bit = 0;
+    while (v >>= 1) bit++;
+    return bit;
+#endif
+}
+
+static int bucket_of(int value) {
+    if (value < SUB_COUNT) return value < 0 ? 0 : value;
+    int shift = highest_bit((unsigned)value) - MLQ_HIST_SUB_BITS;
+    return ((shift + 1) << MLQ_HIST_SUB_BITS) + ((value >> shift) & (SUB_COUNT - 1));
+}
+
+// Largest value that lands in the bucket
+static int bucket_high(int bucket) {
+    if (bucket < SUB_COUNT) return bucket;
+    int shift = (bucket >> MLQ_HIST_SUB_BITS) - 1;
+    long long low = (long long)(SUB_COUNT + (bucket & (SUB_COUNT - 1))) << shift;
+    long long high = low + (1LL << shift) - 1;
+    return high > 0x7fffffff ? 0x7fffffff : (int)high;
+}
+
+void mlq_hist_record(MlqHistogram *h, int value) {
+    h->counts[bucket_of(value)]++;
+    h->total++;
+}
+
+int mlq_hist_quantile(const MlqHistogram *h, double q) {
+    if (h->total == 0) return 0;
+    long long rank = (long long)ceil(q * h->total);
+    if (rank < 1) rank = 1;
+    long long seen = 0;
+    for (int b = 0; b < MLQ_HIST_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) return bucket_high(b);
+    }
+    return bucket_high(MLQ_HIST_BUCKETS - 1);
+}
+
+static void running_add(MlqRunning *r, int value) {
+    if (r->count == 0 || value < r->min) r->min = value;
+    if (r->count == 0 || value > r->max) r->max = value;
+    r->count++;
+    double delta = value - r->mean;
+    r->mean += delta / r->count;
+    r->m2 += delta * (value - r->mean);
+}
+
+double mlq_running_stddev(const MlqRunning *r) {
+    return r->count > 1 ? sqrt(r->m2 / (r->count - 1)) : 0;
+}
+
+static void series_add(MlqSeries *s, int value) {
+    running_add(&s->stats, value);
+    mlq_hist_record(&s->hist, value);
+}
+
+int mlq_series_quantile(const MlqSeries *s, double q) {
+    int v = mlq_hist_quantile(&s->hist, q);
+    return s->stats.count > 0 && v > s->stats.max ? s->stats.max : v;
+}
+
+int mlq_metrics_init(MlqMetrics *m, const MlqSim *sim) {
+    memset(m, 0, sizeof(*m));
+    m->sim = sim;
+    return mlq_metrics_reset(m);
+}
+
+void mlq_metrics_free(MlqMetrics *m) {
+    free(m->started);
+    free(m->last_pid);
+    memset(m, 0, sizeof(*m));
+}
+
+int mlq_metrics_reset(MlqMetrics *m) {
+    const MlqSim *sim = m->sim;
+    if (sim->process_count > m->process_capacity) {
+        unsigned char *started = realloc(m->started, (size_t)sim->process_count);
+        if (!started) return -1;
+        m->started = started;
+        m->process_capacity = sim->process_count;
+    }
+    if (sim->cpu_count > m->cpu_capacity) {
+        int *last_pid = realloc(m->last_pid, sizeof(int) * sim->cpu_count);
+        if (!last_pid) return -1;
+        m->last_pid = last_pid;
+        m->cpu_capacity = sim->cpu_count;
+    }
+
+    memset(m->series, 0, sizeof(m->series));
+    if (m->started) memset(m->started, 0, (size_t)m->process_capacity);
+    for (int c = 0; c < m->cpu_capacity; c++) m->last_pid[c] = -1;
+    m->busy_ticks = 0;
+    m->idle_ticks = 0;
+    m->dispatches = 0;
+    m->context_switches = 0;
+    m->promotions = 0;
+    m->demotions = 0;
+    m->migrations = 0;
+    m->preemptions = 0;
+    m->completions = 0;
+    m->end_time = 0;
+    return 0;
+}
+
+static void record_latency(MlqMetrics *m, int level, MlqMetricKind kind, int value) {
+    series_add(&m->series[level - 1][kind], value);
+    series_add(&m->series[NUM_QUEUES][kind], value);
+}
+
+void mlq_metrics_event(MlqMetrics *m, const MlqEvent *ev) {
+    if (ev->time + ev->duration > m->end_time) m->end_time = ev->time + ev->duration;
+
+    switch (ev->kind) {
+        case MLQ_EV_DISPATCH: {
+            const MlqProcess *p = &m->sim->processes[ev->pid];
+            m->dispatches++;
+            m->busy_ticks += ev->duration;
+            if (ev->cpu >= 0 && ev->cpu < m->cpu_capacity) {
+                if (m->last_pid[ev->cpu] != ev->pid) m->context_switches++;
+                m->last_pid[ev->cpu] = ev->pid;
+            }
+            if (ev->pid < m->process_capacity && !m->started[ev->pid]) {
+                m->started[ev->pid] = 1;
+                record_latency(m, p->original_priority, MLQ_METRIC_RESPONSE, ev->time - p->arrival_time);
+            }
+            break;
+        }
+        case MLQ_EV_COMPLETE: {
+            const MlqProcess *p = &m->sim->processes[ev->pid];
+            int turnaround = ev->time - p->arrival_time;
+            m->completions++;
+            record_latency(m, p->original_priority, MLQ_METRIC_TURNAROUND, turnaround);
+            record_latency(m, p->original_priority, MLQ_METRIC_WAITING, turnaround - p->burst_time);
+            break;
+        }
+        case MLQ_EV_IDLE:
+            m->idle_ticks += ev->duration;
+            break;
+        case MLQ_EV_PROMOTE:
+            m->promotions++;
+            break;
+        case MLQ_EV_DEMOTE:
+            m->demotions++;
+            break;
+        case MLQ_EV_MIGRATE:
+            m->migrations++;
+            break;
+        case MLQ_EV_PREEMPT:
+            m->preemptions++;
+            break;
+        case MLQ_EV_ARRIVE:
+            break;
+    }
+}
+
+void mlq_metrics_on_event(const MlqEvent *ev, void *user) {
+    mlq_metrics_event(user, ev);
+}
+
+double mlq_metrics_utilisation(const MlqMetrics *m) {
+    long long capacity = (long long)m->end_time * m->sim->cpu_count;
+    return capacity > 0 ? (double)m->busy_ticks / capacity : 0;
+}
+
+static const char *kind_names[MLQ_METRIC_KINDS] = {"response", "waiting", "turnaround"};
+
+void mlq_metrics_write_json(FILE *out, const MlqMetrics *m) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"cpus\": %d,\n", m->sim->cpu_count);
+    fprintf(out, "  \"end_time\": %d,\n", m->end_time);
+    fprintf(out, "  \"utilisation\": %.4f,\n", mlq_metrics_utilisation(m));
+    fprintf(out, "  \"busy_ticks\": %lld,\n", m->busy_ticks);
+    fprintf(out, "  \"idle_ticks\": %lld,\n", m->idle_ticks);
+    fprintf(out, "  \"dispatches\": %lld,\n", m->dispatches);
+    fprintf(out, "  \"context_switches\": %lld,\n", m->context_switches);
+    fprintf(out, "  \"promotions\": %lld,\n", m->promotions);
+    fprintf(out, "  \"demotions\": %lld,\n", m->demotions);
+    fprintf(out, "  \"migrations\": %lld,\n", m->migrations);
+    fprintf(out, "  \"preemptions\": %lld,\n", m->preemptions);
+    fprintf(out, "  \"completions\": %lld,\n", m->completions);
+    fprintf(out, "  \"queues\": [\n");
+    for (int q = 0; q <= NUM_QUEUES; q++) {
+        if (q < NUM_QUEUES) fprintf(out, "    {\"priority\": %d", q + 1);
+        else fprintf(out, "    {\"priority\": \"all\"");
+        for (int k = 0; k < MLQ_METRIC_KINDS; k++) {
+            const MlqSeries *s = &m->series[q][k];
+            fprintf(out, ",\n     \"%s\": {\"count\": %lld, \"mean\": %.3f, \"stddev\": %.3f, "
+                         "\"min\": %d, \"p50\": %d, \"p90\": %d, \"p99\": %d, \"p999\": %d, \"max\": %d}",
+                    kind_names[k], s->stats.count, s->stats.mean, mlq_running_stddev(&s->stats),
+                    s->stats.min, mlq_series_quantile(s, 0.5), mlq_series_quantile(s, 0.9),
+                    mlq_series_quantile(s, 0.99), mlq_series_quantile(s, 0.999), s->stats.max);
+        }
+        fprintf(out, "}%s\n", q < NUM_QUEUES ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+void mlq_metrics_write_csv(FILE *out, const MlqMetrics *m) {
+    fprintf(out, "priority,metric,count,mean,stddev,min,p50,p90,p99,p999,max\n");
+    for (int q = 0; q <= NUM_QUEUES; q++) {
+        for (int k = 0; k < MLQ_METRIC_KINDS; k++) {
+            const MlqSeries *s = &m->series[q][k];
+            if (q < NUM_QUEUES) fprintf(out, "%d", q + 1);
+            else fprintf(out, "all");
+            fprintf(out, ",%s,%lld,%.3f,%.3f,%d,%d,%d,%d,%d,%d\n", kind_names[k], s->stats.count,
+                    s->stats.mean, mlq_running_stddev(&s->stats), s->stats.min, mlq_series_quantile(s, 0.5),
+                    mlq_series_quantile(s, 0.9), mlq_series_quantile(s, 0.99), mlq_series_quantile(s, 0.999),
+                    s->stats.max);
+        }
+    }
+    fprintf(out, "# utilisation,%.4f\n", mlq_metrics_utilisation(m));
+    fprintf(out, "# context_switches,%lld\n# promotions,%lld\n# demotions,%lld\n# migrations,%lld\n",
+            m->context_switches, m->promotions, m->demotions, m->migrations);
+    fprintf(out, "# preemptions,%lld\n", m->preemptions);
+}
@@ -0,0 +1,88 @@
+#ifndef MLQ_METRICS_H
+#define MLQ_METRICS_H
+
+#include <stdio.h>
+
+#include "mlq_engine.h"
+
+// Log-linear histogram: exact below 2^SUB_BITS, then 2^SUB_BITS buckets
+// per power of two (about 3% relative error), fixed memory for any int
+#define MLQ_HIST_SUB_BITS 5
+#define MLQ_HIST_BUCKETS ((32 - MLQ_HIST_SUB_BITS) << MLQ_HIST_SUB_BITS)
+
+typedef struct {
+    long long counts[MLQ_HIST_BUCKETS];
+    long long total;
+} MlqHistogram;
+
+// Welford running mean and variance
+typedef struct {
+    long long count;
+    double mean;
+    double m2;
+    int min;
+    int max;
+} MlqRunning;
+
+typedef struct {
+    MlqRunning stats;
+    MlqHistogram hist;
+} MlqSeries;
+
+typedef enum {
+    MLQ_METRIC_RESPONSE,
+    MLQ_METRIC_WAITING,
+    MLQ_METRIC_TURNAROUND,
+    MLQ_METRIC_KINDS
+} MlqMetricKind;
+
+// Scheduling metrics built from the event stream alone, O(1) per event.
+// Latencies are grouped by the priority a process arrived with; row
+// NUM_QUEUES holds all processes. Only the workload fields of the
+// simulator (arrival, burst, original priority, CPU count) are read, so
+// the metrics can be fed on another thread while the engine runs.
+typedef struct {
+    const MlqSim *sim;
+    MlqSeries series[NUM_QUEUES + 1][MLQ_METRIC_KINDS];
+
+    unsigned char *started;         // per process, first dispatch seen
+    int process_capacity;
+    int *last_pid;                  // per CPU, for context switches
+    int cpu_capacity;
+
+    long long busy_ticks;
+    long long idle_ticks;
+    long long dispatches;
+    long long context_switches;     // dispatches of a different process than the CPU ran last
+    long long promotions;
+    long long demotions;
+    long long migrations;
+    long long preemptions;
+    long long completions;
+    int end_time;
+} MlqMetrics;
+
+void mlq_hist_record(MlqHistogram *h, int value);
+// Smallest value v with at least q of the samples <= v, to bucket precision
+int mlq_hist_quantile(const MlqHistogram *h, double q);
+
+double mlq_running_stddev(const MlqRunning *r);
+// Histogram quantile clamped to the exact maximum, which a bucket bound can overshoot
+int mlq_series_quantile(const MlqSeries *s, double q);
+
+int mlq_metrics_init(MlqMetrics *m, const MlqSim *sim);
+void mlq_metrics_free(MlqMetrics *m);
+// Start over for the simulator's current workload and CPU count
+int mlq_metrics_reset(MlqMetrics *m);
+
+void mlq_metrics_event(MlqMetrics *m, const MlqEvent *ev);
+// Adapter for MlqSim.on_event with the metrics as user data
+void mlq_metrics_on_event(const MlqEvent *ev, void *user);
+
+// Busy share of the CPU time up to the latest event
+double mlq_metrics_utilisation(const MlqMetrics *m);
+
+void mlq_metrics_write_json(FILE *out, const MlqMetrics *m);
+void mlq_metrics_write_csv(FILE *out, const MlqMetrics *m);
+
+#endif
@@ -0,0 +1,362 @@
+#include "mlq_policy.h"
+#include "mlq_profile.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define VTIME_UNIT 1024             // virtual time per tick at weight 1
+
+// Share of a priority level: each level gets twice the CPU of the one below
+static long long level_weight(int level) {
+    return 1LL << (NUM_QUEUES - level);
+}
+
+static int key_before(const MlqProcess *procs, int a, int b) {
+    return procs[a].sched_key < procs[b].sched_key ||
+           (procs[a].sched_key == procs[b].sched_key && a < b);
+}
+
+// AVL tree linked through the processes, so queueing never allocates
+
+static int height(const MlqProcess *procs, int n) {
+    return n < 0 ? 0 : procs[n].tree_height;
+}
+
+static void update_height(MlqProcess *procs, int n) {
+    int l = height(procs, procs[n].tree_left);
+    int r = height(procs, procs[n].tree_right);
+    procs[n].tree_height = 1 + (l > r ? l : r);
+}
+
+static int rotate_right(MlqProcess *procs, int n) {
+    int l = procs[n].tree_left;
+    procs[n].tree_left = procs[l].tree_right;
+    procs[l].tree_right = n;
+    update_height(procs, n);
+    update_height(procs, l);
+    return l;
+}
+
+static int rotate_left(MlqProcess *procs, int n) {
+    int r = procs[n].tree_right;
+    procs[n].tree_right = procs[r].tree_left;
+    procs[r].tree_left = n;
+    update_height(procs, n);
+    update_height(procs, r);
+    return r;
+}
+
+static int rebalance(MlqProcess *procs, int n) {
+    update_height(procs, n);
+    int l = procs[n].tree_left;
+    int r = procs[n].tree_right;
+    int balance = height(procs, l) - height(procs, r);
+    if (balance > 1) {
+        if (height(procs, procs[l].tree_left) < height(procs, procs[l].tree_right)) {
+            procs[n].tree_left = rotate_left(procs, l);
+        }
+        return rotate_right(procs, n);
+    }
+    if (balance < -1) {
+        if (height(procs, procs[r].tree_right) < height(procs, procs[r].tree_left)) {
+            procs[n].tree_right = rotate_right(procs, r);
+        }
+        return rotate_left(procs, n);
+    }
+    return n;
+}
+
+static int tree_insert(MlqProcess *procs, int root, int pid) {
+    if (root < 0) {
+        procs[pid].tree_left = -1;
+        procs[pid].tree_right = -1;
+        procs[pid].tree_height = 1;
+        return pid;
+    }
+    if (key_before(procs, pid, root)) procs[root].tree_left = tree_insert(procs, procs[root].tree_left, pid);
+    else procs[root].tree_right = tree_insert(procs, procs[root].tree_right, pid);
+    return rebalance(procs, root);
+}
+
+// Unlink the leftmost node of the subtree into *min
+static int tree_remove_min(MlqProcess *procs, int root, int *min) {
+    if (procs[root].tree_left < 0) {
+        *min = root;
+        return procs[root].tree_right;
+    }
+    procs[root].tree_left = tree_remove_min(procs, procs[root].tree_left, min);
+    return rebalance(procs, root);
+}
+
+static int tree_remove(MlqProcess *procs, int root, int pid) {
+    if (root < 0) return -1;
+    if (root == pid) {
+        int l = procs[root].tree_left;
+        int r = procs[root].tree_right;
+        if (r < 0) return l;
+        int min;
+        r = tree_remove_min(procs, r, &min);
+        procs[min].tree_left = l;
+        procs[min].tree_right = r;
+        return rebalance(procs, min);
+    }
+    if (key_before(procs, pid, root)) procs[root].tree_left = tree_remove(procs, procs[root].tree_left, pid);
+    else procs[root].tree_right = tree_remove(procs, procs[root].tree_right, pid);
+    return rebalance(procs, root);
+}
+
+// In-order search that stops at the first hit; only processes whose last
+// slice ends after `time` are skipped, and there are few of those
+static int tree_first_ready(const MlqProcess *procs, int n, int time) {
+    if (n < 0) return -1;
+    MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, 1);
+    int found = tree_first_ready(procs, procs[n].tree_left, time);
+    if (found >= 0) return found;
+    if (procs[n].ready_at <= time) return n;
+    return tree_first_ready(procs, procs[n].tree_right, time);
+}
+
+static int tree_last_ready(const MlqProcess *procs, int n, int time) {
+    if (n < 0) return -1;
+    MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, 1);
+    int found = tree_last_ready(procs, procs[n].tree_right, time);
+    if (found >= 0) return found;
+    if (procs[n].ready_at <= time) return n;
+    return tree_last_ready(procs, procs[n].tree_left, time);
+}
+
+// Binary heap of pids; each process knows its slot so it can be removed
+
+static void heap_place(MlqProcess *procs, int *heap, int i, int pid) {
+    heap[i] = pid;
+    procs[pid].heap_index = i;
+}
+
+static void sift_up(MlqProcess *procs, int *heap, int i) {
+    int pid = heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!key_before(procs, pid, heap[parent])) break;
+        heap_place(procs, heap, i, heap[parent]);
+        i = parent;
+    }
+    heap_place(procs, heap, i, pid);
+}
+
+static void sift_down(MlqProcess *procs, int *heap, int count, int i) {
+    int pid = heap[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && key_before(procs, heap[child + 1], heap[child])) child++;
+        if (!key_before(procs, heap[child], pid)) break;
+        heap_place(procs, heap, i, heap[child]);
+        i = child;
+    }
+    heap_place(procs, heap, i, pid);
+}
+
+static int heap_push(MlqSim *sim, MlqCpu *cpu, int pid) {
+    if (cpu->heap_count == cpu->heap_capacity) {
+        int cap = cpu->heap_capacity ? cpu->heap_capacity * 2 : 64;
+        int *grown = realloc(cpu->heap, sizeof(int) * cap);
+        if (!grown) return -1;
+        cpu->heap = grown;
+        cpu->heap_capacity = cap;
+    }
+    int i = cpu->heap_count++;
+    heap_place(sim->processes, cpu->heap, i, pid);
+    sift_up(sim->processes, cpu->heap, i);
+    return 0;
+}
+
+static void heap_remove(MlqSim *sim, MlqCpu *cpu, int pid) {
+    MlqProcess *procs = sim->processes;
+    int i = procs[pid].heap_index;
+    int last = cpu->heap[--cpu->heap_count];
+    procs[pid].heap_index = -1;
+    if (i == cpu->heap_count) return;
+    heap_place(procs, cpu->heap, i, last);
+    sift_up(procs, cpu->heap, i);
+    sift_down(procs, cpu->heap, cpu->heap_count, procs[last].heap_index);
+}
+
+// Slot order is close to dispatch order near the root, which is all
+// balancing needs
+static int heap_first_ready(const MlqSim *sim, int c, int time) {
+    const MlqCpu *cpu = &sim->cpus[c];
+    for (int i = 0; i < cpu->heap_count; i++) {
+        MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, 1);
+        if (sim->processes[cpu->heap[i]].ready_at <= time) return cpu->heap[i];
+    }
+    return -1;
+}
+
+static int heap_last_ready(const MlqSim *sim, int c, int time) {
+    const MlqCpu *cpu = &sim->cpus[c];
+    for (int i = cpu->heap_count - 1; i >= 0; i--) {
+        MLQ_PROF_COUNT(MLQ_COUNT_QUEUE_SCAN, 1);
+        if (sim->processes[cpu->heap[i]].ready_at <= time) return cpu->heap[i];
+    }
+    return -1;
+}
+
+static void heap_remove_op(MlqSim *sim, int c, int pid) {
+    heap_remove(sim, &sim->cpus[c], pid);
+}
+
+static int heap_pick(MlqSim *sim, int c, int now) {
+    MlqCpu *cpu = &sim->cpus[c];
+    int pid = cpu->heap[0];
+    heap_remove(sim, cpu, pid);
+    return pid;
+}
+
+static void no_tick(MlqSim *sim, int c, int pid, int ran, int now) {
+}
+
+static void no_complete(MlqSim *sim, int c, int pid) {
+}
+
+// Virtual time (CFS vruntime, stride pass) grows by the ticks run over the
+// level's weight. Off a queue it is kept relative to the CPU's vclock, so
+// a migrated process keeps its lag and a new one starts level.
+static void advance_vclock(MlqCpu *cpu, long long key) {
+    if (key > cpu->vclock) cpu->vclock = key;
+}
+
+static void charge_tick(MlqSim *sim, int c, int pid, int ran, int now) {
+    MlqProcess *p = &sim->processes[pid];
+    p->sched_key += (long long)ran * VTIME_UNIT / level_weight(p->priority);
+}
+
+// CFS: the least virtual runtime runs next, so levels share the CPU by
+// weight. The period is the sum of the quanta, split by weight, and no
+// slice is shorter than quantum 1.
+
+static int cfs_enqueue(MlqSim *sim, int c, int pid, int wakeup) {
+    MlqCpu *cpu = &sim->cpus[c];
+    MlqProcess *p = &sim->processes[pid];
+    if (wakeup) p->sched_key += cpu->vclock;
+    cpu->weight += level_weight(p->priority);
+    cpu->tree_root = tree_insert(sim->processes, cpu->tree_root, pid);
+    return 0;
+}
+
+static void cfs_remove(MlqSim *sim, int c, int pid) {
+    MlqCpu *cpu = &sim->cpus[c];
+    MlqProcess *p = &sim->processes[pid];
+    cpu->tree_root = tree_remove(sim->processes, cpu->tree_root, pid);
+    cpu->weight -= level_weight(p->priority);
+    p->sched_key -= cpu->vclock;
+}
+
+static int cfs_pick(MlqSim *sim, int c, int now) {
+    MlqCpu *cpu = &sim->cpus[c];
+    int pid;
+    cpu->tree_root = tree_remove_min(sim->processes, cpu->tree_root, &pid);
+    cpu->weight -= level_weight(sim->processes[pid].priority);
+    advance_vclock(cpu, sim->processes[pid].sched_key);
+    return pid;
+}
+
+static int cfs_slice(const MlqSim *sim, int c, int pid) {
+    const MlqCpu *cpu = &sim->cpus[c];
+    const int *tq = sim->config.time_quantum;
+    long long latency = 0;
+    for (int q = 0; q < NUM_QUEUES; q++) latency += tq[q];
+    int min_slice = tq[0] > 0 ? tq[0] : 1;
+
+    // The picked process is off the tree but still counted in ready_count
+    long long period = (long long)cpu->ready_count * min_slice;
+    if (period < latency) period = latency;
+    long long weight = level_weight(sim->processes[pid].priority);
+    long long slice = period * weight / (cpu->weight + weight);
+    return slice > min_slice ? (int)slice : min_slice;
+}
+
+static int cfs_first_ready(const MlqSim *sim, int c, int time) {
+    return tree_first_ready(sim->processes, sim->cpus[c].tree_root, time);
+}
+
+static int cfs_last_ready(const MlqSim *sim, int c, int time) {
+    return tree_last_ready(sim->processes, sim->cpus[c].tree_root, time);
+}
+
+const MlqPolicy mlq_policy_cfs = {
+    "cfs", cfs_enqueue, cfs_remove, cfs_pick, cfs_slice, charge_tick, no_complete,
+    cfs_first_ready, cfs_last_ready,
+};
+
+// EDF: the earliest absolute deadline runs, a level's quantum at a time.
+// Traces carry no deadlines, so a process is given 2^priority times its
+// burst from arrival: tighter for the higher levels.
+
+static int edf_enqueue(MlqSim *sim, int c, int pid, int wakeup) {
+    MlqProcess *p = &sim->processes[pid];
+    if (wakeup) p->sched_key = p->arrival_time + ((long long)p->burst_time << p->priority);
+    return heap_push(sim, &sim->cpus[c], pid);
+}
+
+static int level_quantum(const MlqSim *sim, int c, int pid) {
+    int tq = sim->config.time_quantum[sim->processes[pid].priority - 1];
+    return tq > 0 ? tq : 1;
+}
+
+const MlqPolicy mlq_policy_edf = {
+    "edf", edf_enqueue, heap_remove_op, heap_pick, level_quantum, no_tick, no_complete,
+    heap_first_ready, heap_last_ready,
+};
+
+// Stride: tickets by level, the lowest pass runs for quantum 1, and the
+// pass advances by the ticks run over the tickets. This is lottery
+// scheduling's proportional share without the random draw.
+
+static int stride_enqueue(MlqSim *sim, int c, int pid, int wakeup) {
+    MlqCpu *cpu = &sim->cpus[c];
+    if (wakeup) sim->processes[pid].sched_key += cpu->vclock;
+    return heap_push(sim, cpu, pid);
+}
+
+static void stride_remove(MlqSim *sim, int c, int pid) {
+    heap_remove(sim, &sim->cpus[c], pid);
+    sim->processes[pid].sched_key -= sim->cpus[c].vclock;
+}
+
+static int stride_pick(MlqSim *sim, int c, int now) {
+    int pid = heap_pick(sim, c, now);
+    advance_vclock(&sim->cpus[c], sim->processes[pid].sched_key);
+    return pid;
+}
+
+static int stride_slice(const MlqSim *sim, int c, int pid) {
+    return sim->config.time_quantum[0] > 0 ? sim->config.time_quantum[0] : 1;
+}
+
+const MlqPolicy mlq_policy_stride = {
+    "stride", stride_enqueue, stride_remove, stride_pick, stride_slice, charge_tick, no_complete,
+    heap_first_ready, heap_last_ready,
+};
+
+static const MlqPolicy *const policies[MLQ_POLICY_COUNT] = {
+    &mlq_policy_mlq, &mlq_policy_cfs, &mlq_policy_edf, &mlq_policy_stride,
+};
+
+const MlqPolicy *mlq_policy_get(MlqPolicyKind kind) {
+    if (kind < 0 || kind >= MLQ_POLICY_COUNT) kind = MLQ_POLICY_MLQ;
+    return policies[kind];
+}
+
+const char *mlq_policy_name(MlqPolicyKind kind) {
+    return mlq_policy_get(kind)->name;
+}
+
+int mlq_policy_parse(const char *name, MlqPolicyKind *kind) {
+    for (int k = 0; k < MLQ_POLICY_COUNT; k++) {
+        if (strcmp(name, policies[k]->name) == 0) {
+            *kind = (MlqPolicyKind)k;
+            return 0;
+        }
+    }
+    return -1;
+}
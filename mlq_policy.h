@@ -0,0 +1,43 @@
+#ifndef MLQ_POLICY_H
+#define MLQ_POLICY_H
+
+#include "mlq_engine.h"
+
+// A scheduling policy orders the run queue of each CPU and sizes slices.
+// The engine keeps admission, placement, balancing, idling and the per-run
+// accounting, and calls these hooks for the CPU involved. A process taken
+// by pick_next is off the queue until enqueue puts it back.
+typedef struct MlqPolicy {
+    const char *name;
+
+    // Queue a runnable process on CPU c. `wakeup` is set when it arrives
+    // or migrates, clear when it comes back after its own slice. Returns
+    // -1 if the queue could not grow.
+    int (*enqueue)(MlqSim *sim, int c, int pid, int wakeup);
+    // Take a queued process off CPU c, for migration
+    void (*remove)(MlqSim *sim, int c, int pid);
+    // Dequeue the process to run next; the queue is not empty
+    int (*pick_next)(MlqSim *sim, int c, int now);
+    // Ticks the picked process may run before CPU c decides again
+    int (*slice)(const MlqSim *sim, int c, int pid);
+    // Charge the slice that just ran; `now` is the end of the slice
+    void (*tick)(MlqSim *sim, int c, int pid, int ran, int now);
+    void (*on_complete)(MlqSim *sim, int c, int pid);
+
+    // First and last queued process in roughly dispatch order that may run
+    // by `time`, or -1; balancing steals the first and pushes the last
+    int (*first_ready)(const MlqSim *sim, int c, int time);
+    int (*last_ready)(const MlqSim *sim, int c, int time);
+} MlqPolicy;
+
+extern const MlqPolicy mlq_policy_mlq;      // in mlq_engine.c
+extern const MlqPolicy mlq_policy_cfs;
+extern const MlqPolicy mlq_policy_edf;
+extern const MlqPolicy mlq_policy_stride;
+
+const MlqPolicy *mlq_policy_get(MlqPolicyKind kind);
+const char *mlq_policy_name(MlqPolicyKind kind);
+// Accepts mlq, cfs, edf, stride; returns -1 for anything else
+int mlq_policy_parse(const char *name, MlqPolicyKind *kind);
+
+#endif
@@ -0,0 +1,305 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_profile.h"
+
+#ifdef MLQ_PROFILE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define HAVE_TSC 1
+#endif
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#define MAX_DEPTH 15                // 4 bits per open zone in a 64-bit path
+#define PATH_SLOTS 256              // distinct stacks per thread, a power of two
+
+static const char *zone_names[MLQ_ZONE_COUNT] = {
+    "step", "admit", "balance", "dispatch", "aging", "requeue", "timeline", "event", "on_draw",
+};
+static const char *counter_names[MLQ_COUNT_KINDS] = {
+    "steps", "queue scans", "requeues", "demotions", "migrations", "redraws",
+};
+
+// Self cycles of one call stack; key 0 is an empty slot
+typedef struct {
+    uint64_t key;
+    uint64_t cycles;
+} PathEntry;
+
+typedef struct ProfThread {
+    struct ProfThread *next;
+    const char *name;
+    int index;
+    int depth;
+    int overflow;                   // zones opened past MAX_DEPTH, not timed
+    uint64_t path;                  // open zones, each zone + 1, innermost lowest
+    uint64_t start[MAX_DEPTH];
+    uint64_t child[MAX_DEPTH];      // cycles spent in zones nested in each open one
+    uint64_t total[MLQ_ZONE_COUNT];
+    uint64_t self[MLQ_ZONE_COUNT];
+    long long calls[MLQ_ZONE_COUNT];
+    long long counters[MLQ_COUNT_KINDS];
+    PathEntry paths[PATH_SLOTS];
+    uint64_t lost;                  // self cycles of stacks that found no slot
+} ProfThread;
+
+static THREAD_LOCAL ProfThread *self_thread;
+static ProfThread *threads;
+static int thread_count;
+static pthread_mutex_t threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t base_cycles;
+static double base_seconds;
+
+static double wall_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// The TSC where there is one, otherwise nanoseconds
+static uint64_t read_cycles(void) {
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return (uint64_t)(wall_seconds() * 1e9);
+#endif
+}
+
+// The calling thread's buffer, registered on first use. Buffers outlive
+// their threads so a sweep's workers still show up in the report.
+static ProfThread *thread_buffer(void) {
+    if (self_thread) return self_thread;
+    ProfThread *t = calloc(1, sizeof(ProfThread));
+    if (!t) return NULL;
+    pthread_mutex_lock(&threads_lock);
+    if (!threads) {
+        base_cycles = read_cycles();
+        base_seconds = wall_seconds();
+    }
+    t->index = thread_count++;
+    t->next = threads;
+    threads = t;
+    pthread_mutex_unlock(&threads_lock);
+    self_thread = t;
+    return t;
+}
+
+void mlq_profile_begin(MlqZone zone) {
+    ProfThread *t = thread_buffer();
+    if (!t) return;
+    if (t->depth == MAX_DEPTH) {
+        t->overflow++;
+        return;
+    }
+    t->path = (t->path << 4) | (uint64_t)(zone + 1);
+    t->child[t->depth] = 0;
+    t->start[t->depth++] = read_cycles();
+}
+
+static void add_path(ProfThread *t, uint64_t key, uint64_t cycles) {
+    unsigned slot = (unsigned)((key * 0x9e3779b97f4a7c15ULL) >> 56) & (PATH_SLOTS - 1);
+    for (int probe = 0; probe < PATH_SLOTS; probe++) {
+        PathEntry *e = &t->paths[(slot + probe) & (PATH_SLOTS - 1)];
+        if (e->key == key || e->key == 0) {
+            e->key = key;
+            e->cycles += cycles;
+            return;
+        }
+    }
+    t->lost += cycles;
+}
+
+void mlq_profile_end(MlqZone zone) {
+    uint64_t now = read_cycles();
+    ProfThread *t = self_thread;
+    if (!t || t->depth == 0) return;
+    if (t->overflow > 0) {
+        t->overflow--;
+        return;
+    }
+    int d = --t->depth;
+    uint64_t elapsed = now - t->start[d];
+    uint64_t self = elapsed > t->child[d] ? elapsed - t->child[d] : 0;
+    if (d > 0) t->child[d - 1] += elapsed;
+    t->total[zone] += elapsed;
+    t->self[zone] += self;
+    t->calls[zone]++;
+    add_path(t, t->path, self);
+    t->path >>= 4;
+}
+
+void mlq_profile_count(MlqCounter counter, long long n) {
+    ProfThread *t = thread_buffer();
+    if (t) t->counters[counter] += n;
+}
+
+void mlq_profile_thread(const char *name) {
+    ProfThread *t = thread_buffer();
+    if (t) t->name = name;
+}
+
+int mlq_profile_enabled(void) {
+    return 1;
+}
+
+static double cycles_per_ms(void) {
+#ifdef HAVE_TSC
+    double secs = wall_seconds() - base_seconds;
+    if (secs <= 0) return 1e6;
+    return (double)(read_cycles() - base_cycles) / secs / 1000;
+#else
+    return 1e6;
+#endif
+}
+
+// Cost of one counter read; every zone pays two, mostly charged to its parent
+static double read_cost(void) {
+    uint64_t sink = 0, start = read_cycles();
+    for (int i = 0; i < 1000; i++) sink += read_cycles();
+    return (double)(read_cycles() - start - (sink & 1)) / 1001;
+}
+
+void mlq_profile_report(FILE *out) {
+    uint64_t total[MLQ_ZONE_COUNT] = {0}, self[MLQ_ZONE_COUNT] = {0}, all = 0;
+    long long calls[MLQ_ZONE_COUNT] = {0}, counters[MLQ_COUNT_KINDS] = {0};
+    int order[MLQ_ZONE_COUNT];
+
+    pthread_mutex_lock(&threads_lock);
+    int count = thread_count;
+    for (ProfThread *t = threads; t; t = t->next) {
+        for (int z = 0; z < MLQ_ZONE_COUNT; z++) {
+            total[z] += t->total[z];
+            self[z] += t->self[z];
+            calls[z] += t->calls[z];
+        }
+        for (int k = 0; k < MLQ_COUNT_KINDS; k++) counters[k] += t->counters[k];
+    }
+    pthread_mutex_unlock(&threads_lock);
+
+    // Insertion sort by self time, largest first
+    for (int z = 0; z < MLQ_ZONE_COUNT; z++) {
+        int i = z;
+        while (i > 0 && self[order[i - 1]] < self[z]) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = z;
+        all += self[z];
+    }
+
+    double per_ms = cycles_per_ms();
+    fprintf(out, "profile: %d thread%s, %.0f cycles/ms, %.0f cycles per counter read\n", count,
+            count == 1 ? "" : "s", per_ms, read_cost());
+    fprintf(out, "%-10s %12s %10s %7s %10s %12s\n", "zone", "calls", "self ms", "self%", "total ms", "cycles/call");
+    for (int i = 0; i < MLQ_ZONE_COUNT; i++) {
+        int z = order[i];
+        if (calls[z] == 0) continue;
+        fprintf(out, "%-10s %12lld %10.2f %6.1f%% %10.2f %12.0f\n", zone_names[z], calls[z], self[z] / per_ms,
+                all > 0 ? 100.0 * self[z] / all : 0, total[z] / per_ms, (double)total[z] / calls[z]);
+    }
+    for (int k = 0; k < MLQ_COUNT_KINDS; k++) {
+        if (counters[k] == 0) continue;
+        fprintf(out, "%-12s %16lld", counter_names[k], counters[k]);
+        if (k != MLQ_COUNT_STEPS && counters[MLQ_COUNT_STEPS] > 0) {
+            fprintf(out, "  %.2f per step", (double)counters[k] / counters[MLQ_COUNT_STEPS]);
+        }
+        fputc('\n', out);
+    }
+}
+
+static void write_stack(FILE *out, const ProfThread *t, uint64_t key, uint64_t cycles) {
+    int zones[MAX_DEPTH], depth = 0;
+    for (; key != 0 && depth < MAX_DEPTH; key >>= 4) zones[depth++] = (int)(key & 15) - 1;
+    if (t->name) fputs(t->name, out);
+    else fprintf(out, "thread %d", t->index);
+    while (depth > 0) fprintf(out, ";%s", zone_names[zones[--depth]]);
+    fprintf(out, " %llu\n", (unsigned long long)cycles);
+}
+
+int mlq_profile_write_folded(const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) return -1;
+    pthread_mutex_lock(&threads_lock);
+    for (ProfThread *t = threads; t; t = t->next) {
+        for (int s = 0; s < PATH_SLOTS; s++) {
+            if (t->paths[s].key != 0 && t->paths[s].cycles > 0) write_stack(out, t, t->paths[s].key, t->paths[s].cycles);
+        }
+        if (t->lost > 0) {
+            if (t->name) fprintf(out, "%s;other %llu\n", t->name, (unsigned long long)t->lost);
+            else fprintf(out, "thread %d;other %llu\n", t->index, (unsigned long long)t->lost);
+        }
+    }
+    pthread_mutex_unlock(&threads_lock);
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+void mlq_profile_clear(void) {
+    pthread_mutex_lock(&threads_lock);
+    for (ProfThread *t = threads; t; t = t->next) {
+        memset(t->total, 0, sizeof(t->total));
+        memset(t->self, 0, sizeof(t->self));
+        memset(t->calls, 0, sizeof(t->calls));
+        memset(t->counters, 0, sizeof(t->counters));
+        memset(t->paths, 0, sizeof(t->paths));
+        t->lost = 0;
+    }
+    base_cycles = read_cycles();
+    base_seconds = wall_seconds();
+    pthread_mutex_unlock(&threads_lock);
+}
+
+#else
+
+void mlq_profile_begin(MlqZone zone) {
+}
+
+void mlq_profile_end(MlqZone zone) {
+}
+
+void mlq_profile_count(MlqCounter counter, long long n) {
+}
+
+void mlq_profile_thread(const char *name) {
+}
+
+int mlq_profile_enabled(void) {
+    return 0;
+}
+
+void mlq_profile_report(FILE *out) {
+}
+
+int mlq_profile_write_folded(const char *path) {
+    return -1;
+}
+
+void mlq_profile_clear(void) {
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef MLQ_PROFILE_H
+#define MLQ_PROFILE_H
+
+#include <stdio.h>
+
+// Timed regions. They nest, so a zone's self time excludes the zones
+// opened inside it.
+typedef enum {
+    MLQ_ZONE_STEP,              // one mlq_sim_step
+    MLQ_ZONE_ADMIT,             // admitting arrivals
+    MLQ_ZONE_BALANCE,           // steal and push
+    MLQ_ZONE_DISPATCH,          // pick, run and requeue
+    MLQ_ZONE_AGING,             // the aging and demotion pass
+    MLQ_ZONE_REQUEUE,           // putting the process back after its slice
+    MLQ_ZONE_TIMELINE,          // appending a slice to a timeline
+    MLQ_ZONE_EVENT,             // the on_event callback
+    MLQ_ZONE_DRAW,              // the viewer's on_draw
+    MLQ_ZONE_COUNT
+} MlqZone;
+
+typedef enum {
+    MLQ_COUNT_STEPS,
+    MLQ_COUNT_QUEUE_SCAN,       // run-queue entries or aging slots visited
+    MLQ_COUNT_REQUEUE,
+    MLQ_COUNT_DEMOTE,
+    MLQ_COUNT_MIGRATE,
+    MLQ_COUNT_REDRAW,
+    MLQ_COUNT_KINDS
+} MlqCounter;
+
+// Built with -DMLQ_PROFILE the macros read the cycle counter into a buffer
+// owned by the calling thread; no locks or shared writes on the hot path.
+// Without it they compile to nothing and the report functions are no-ops.
+#ifdef MLQ_PROFILE
+#define MLQ_PROF_BEGIN(zone) mlq_profile_begin(zone)
+#define MLQ_PROF_END(zone) mlq_profile_end(zone)
+#define MLQ_PROF_COUNT(counter, n) mlq_profile_count(counter, n)
+#define MLQ_PROF_THREAD(name) mlq_profile_thread(name)
+#else
+#define MLQ_PROF_BEGIN(zone) ((void)0)
+#define MLQ_PROF_END(zone) ((void)0)
+#define MLQ_PROF_COUNT(counter, n) ((void)0)
+#define MLQ_PROF_THREAD(name) ((void)0)
+#endif
+
+void mlq_profile_begin(MlqZone zone);
+void mlq_profile_end(MlqZone zone);
+void mlq_profile_count(MlqCounter counter, long long n);
+// Label the calling thread in the folded dump (default "thread N"); the
+// name is not copied
+void mlq_profile_thread(const char *name);
+
+// Whether this build collects anything (compiled with MLQ_PROFILE)
+int mlq_profile_enabled(void);
+
+// Zones by self time, summed over all threads, then the counters. Zones
+// still open on a running thread are left out.
+void mlq_profile_report(FILE *out);
+// Collapsed stacks ("thread;step;dispatch;aging cycles"), one line per
+// path, for flamegraph.pl or speedscope
+int mlq_profile_write_folded(const char *path);
+// Zero every thread's totals
+void mlq_profile_clear(void);
+
+#endif
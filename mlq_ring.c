@@ -0,0 +1,50 @@
+#include "mlq_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The producer publishes a slot by storing head with release order; the
+// consumer frees it by storing tail the same way. Indices run freely and
+// wrap through the mask.
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+int mlq_ring_init(MlqRing *ring, unsigned capacity) {
+    memset(ring, 0, sizeof(*ring));
+    unsigned cap = 2;
+    while (cap < capacity) cap *= 2;
+    ring->slots = malloc(sizeof(MlqEvent) * cap);
+    if (!ring->slots) return -1;
+    ring->mask = cap - 1;
+    return 0;
+}
+
+void mlq_ring_free(MlqRing *ring) {
+    free(ring->slots);
+    memset(ring, 0, sizeof(*ring));
+}
+
+int mlq_ring_push(MlqRing *ring, const MlqEvent *ev) {
+    unsigned head = ring->head;
+    if (head - ring->tail_cache > ring->mask) {
+        ring->tail_cache = LOAD_ACQUIRE(&ring->tail);
+        if (head - ring->tail_cache > ring->mask) return -1;
+    }
+    ring->slots[head & ring->mask] = *ev;
+    STORE_RELEASE(&ring->head, head + 1);
+    return 0;
+}
+
+unsigned mlq_ring_pop(MlqRing *ring, MlqEvent *out, unsigned max) {
+    unsigned tail = ring->tail;
+    if (ring->head_cache == tail) {
+        ring->head_cache = LOAD_ACQUIRE(&ring->head);
+        if (ring->head_cache == tail) return 0;
+    }
+
+    unsigned n = ring->head_cache - tail;
+    if (n > max) n = max;
+    for (unsigned i = 0; i < n; i++) out[i] = ring->slots[(tail + i) & ring->mask];
+    STORE_RELEASE(&ring->tail, tail + n);
+    return n;
+}
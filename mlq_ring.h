@@ -0,0 +1,36 @@
+#ifndef MLQ_RING_H
+#define MLQ_RING_H
+
+#include "mlq_engine.h"
+
+#define MLQ_CACHE_LINE 64
+
+// Single-producer/single-consumer ring of engine events. Each side owns
+// one index and keeps a cached copy of the other's, so the shared lines
+// are only touched when the cached view runs out. Neither side blocks.
+typedef struct {
+    MlqEvent *slots;
+    unsigned mask;              // capacity - 1, capacity a power of two
+
+    // Producer's line
+    unsigned head;              // next slot to write
+    unsigned tail_cache;
+    char pad_producer[MLQ_CACHE_LINE - 2 * sizeof(unsigned)];
+
+    // Consumer's line
+    unsigned tail;              // next slot to read
+    unsigned head_cache;
+    char pad_consumer[MLQ_CACHE_LINE - 2 * sizeof(unsigned)];
+} MlqRing;
+
+// capacity is rounded up to a power of two
+int mlq_ring_init(MlqRing *ring, unsigned capacity);
+void mlq_ring_free(MlqRing *ring);
+
+// Producer side; returns -1 when the ring is full
+int mlq_ring_push(MlqRing *ring, const MlqEvent *ev);
+
+// Consumer side; copies out up to max events and returns how many
+unsigned mlq_ring_pop(MlqRing *ring, MlqEvent *out, unsigned max);
+
+#endif
@@ -0,0 +1,249 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_shm.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+// Single writer: seq goes odd before any field changes and even after all
+// of them have
+static void write_begin(uint32_t *seq) {
+    __atomic_store_n(seq, *seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void write_end(uint32_t *seq) {
+    STORE_RELEASE(seq, *seq + 1);
+}
+
+static void read_consistent(const uint32_t *seq, void *out, const void *src, size_t size) {
+    for (;;) {
+        uint32_t before = LOAD_ACQUIRE(seq);
+        if (before & 1) continue;
+        memcpy(out, src, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (LOAD_RELAXED(seq) == before) return;
+    }
+}
+
+static void publish_status(MlqShm *shm) {
+    MlqShmState *s = shm->state;
+    const MlqSim *sim = shm->sim;
+    write_begin(&s->seq);
+    s->status.cpu_count = sim->cpu_count;
+    s->status.process_count = sim->process_count;
+    s->status.finished_count = sim->finished_count;
+    s->status.current_time = sim->current_time;
+    s->status.makespan = sim->makespan;
+    s->status.steps = sim->steps;
+    write_end(&s->seq);
+}
+
+static void publish_cpu(MlqShm *shm, int c, const MlqEvent *dispatch) {
+    MlqShmCpu *out = &shm->state->cpus[c];
+    const MlqCpu *cpu = &shm->sim->cpus[c];
+    write_begin(&out->seq);
+    out->clock = cpu->clock;
+    out->ready = cpu->ready_count;
+    for (int q = 0; q < NUM_QUEUES; q++) out->level_count[q] = cpu->level_count[q];
+    if (dispatch) {
+        out->running = dispatch->pid;
+        out->running_level = dispatch->pid >= 0 ? dispatch->queue_level : 0;
+    }
+    write_end(&out->seq);
+}
+
+void mlq_shm_reset(MlqShm *shm) {
+    MlqShmState *s = shm->state;
+    MlqEvent idle = {MLQ_EV_IDLE, -1, 0, 0, 0, 0};
+    write_begin(&s->seq);
+    s->status.run++;
+    s->status.done = 0;
+    STORE_RELEASE(&s->slice_count, 0);
+    write_end(&s->seq);
+    for (int c = 0; c < shm->sim->cpu_count; c++) publish_cpu(shm, c, &idle);
+    publish_status(shm);
+}
+
+void mlq_shm_event(MlqShm *shm, const MlqEvent *ev) {
+    MlqShmState *s = shm->state;
+    int is_slice = ev->kind == MLQ_EV_DISPATCH || ev->kind == MLQ_EV_IDLE;
+    if (is_slice) {
+        int64_t k = s->slice_count;
+        MlqSlice *slot = &s->slices[k & (MLQ_SHM_SLICES - 1)];
+        // Slice k overwrites slice k - MLQ_SHM_SLICES. A reader that sees
+        // any of these stores must also see slice_count at k, which marks
+        // the old slice gone, as in write_begin
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        slot->pid = ev->pid;
+        slot->start_time = ev->time;
+        slot->duration = ev->duration;
+        slot->queue_level = (short)ev->queue_level;
+        slot->cpu = (short)ev->cpu;
+        STORE_RELEASE(&s->slice_count, k + 1);
+    }
+    if (ev->kind == MLQ_EV_MIGRATE) {
+        // The event names only the destination
+        for (int c = 0; c < shm->sim->cpu_count; c++) publish_cpu(shm, c, NULL);
+    } else if (ev->cpu >= 0 && ev->cpu < shm->sim->cpu_count) {
+        publish_cpu(shm, ev->cpu, is_slice ? ev : NULL);
+    }
+    // Time and steps move with slices, the finished count with completions
+    if (is_slice || ev->kind == MLQ_EV_COMPLETE) publish_status(shm);
+}
+
+void mlq_shm_finish(MlqShm *shm) {
+    for (int c = 0; c < shm->sim->cpu_count; c++) publish_cpu(shm, c, NULL);
+    publish_status(shm);
+    write_begin(&shm->state->seq);
+    shm->state->status.done = 1;
+    write_end(&shm->state->seq);
+}
+
+void mlq_shm_read_status(const MlqShmState *state, MlqShmStatus *out) {
+    read_consistent(&state->seq, out, &state->status, sizeof(*out));
+}
+
+void mlq_shm_read_cpu(const MlqShmState *state, int cpu, MlqShmCpu *out) {
+    read_consistent(&state->cpus[cpu].seq, out, &state->cpus[cpu], sizeof(*out));
+}
+
+static int current_run(const MlqShmState *state) {
+    MlqShmStatus status;
+    mlq_shm_read_status(state, &status);
+    return status.run;
+}
+
+int mlq_shm_read_slices(const MlqShmState *state, int run, int64_t from, MlqSlice *out, int max, int64_t *first) {
+    if (current_run(state) != run) return -1;
+    int64_t count = LOAD_ACQUIRE(&state->slice_count);
+    int64_t lo = from, hi;
+    if (lo < count - MLQ_SHM_SLICES) lo = count - MLQ_SHM_SLICES;
+    if (lo > count) lo = count;
+    hi = lo + max < count ? lo + max : count;
+    for (int64_t k = lo; k < hi; k++) out[k - lo] = state->slices[k & (MLQ_SHM_SLICES - 1)];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    // Slot k is rewritten once the writer reaches slice k + MLQ_SHM_SLICES,
+    // so only copies above that are sure to be whole
+    int64_t now = LOAD_RELAXED(&state->slice_count);
+    if (current_run(state) != run) return -1;
+    int64_t safe = now - MLQ_SHM_SLICES + 1;
+    int skip = lo < safe ? (int)((safe < hi ? safe : hi) - lo) : 0;
+    if (skip > 0) memmove(out, out + skip, sizeof(MlqSlice) * (size_t)(hi - lo - skip));
+    *first = lo + skip;
+    return (int)(hi - lo - skip);
+}
+
+#ifndef _WIN32
+
+int mlq_shm_create(MlqShm *shm, const char *name, const MlqSim *sim) {
+    memset(shm, 0, sizeof(*shm));
+    if (strlen(name) >= sizeof(shm->name)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return -1;
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, sizeof(MlqShmState)) == 0) {
+        map = mmap(NULL, sizeof(MlqShmState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int saved = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        shm_unlink(name);
+        errno = saved;
+        return -1;
+    }
+
+    // A reader that maps us mid-setup sees magic 0 and retries
+    MlqShmState *s = map;
+    STORE_RELEASE(&s->magic, 0);
+    memset((char *)s + sizeof(s->magic), 0, sizeof(MlqShmState) - sizeof(s->magic));
+    s->version = MLQ_SHM_VERSION;
+    s->size = sizeof(MlqShmState);
+    s->num_queues = NUM_QUEUES;
+    s->slice_capacity = MLQ_SHM_SLICES;
+    s->writer_pid = (int32_t)getpid();
+    for (int c = 0; c < MLQ_MAX_CPUS; c++) s->cpus[c].running = -1;
+
+    shm->state = s;
+    shm->sim = sim;
+    strcpy(shm->name, name);
+    publish_status(shm);
+    STORE_RELEASE(&s->magic, MLQ_SHM_MAGIC);
+    return 0;
+}
+
+void mlq_shm_close(MlqShm *shm) {
+    if (!shm->state) return;
+    munmap(shm->state, sizeof(MlqShmState));
+    shm_unlink(shm->name);
+    memset(shm, 0, sizeof(*shm));
+}
+
+int mlq_shm_open(const char *name, const MlqShmState **state) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return -1;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0) {
+        if ((size_t)st.st_size < sizeof(MlqShmState)) errno = st.st_size == 0 ? EAGAIN : EPROTO;
+        else map = mmap(NULL, sizeof(MlqShmState), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    int saved = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        errno = saved;
+        return -1;
+    }
+
+    const MlqShmState *s = map;
+    uint32_t magic = LOAD_ACQUIRE(&s->magic);
+    if (magic != MLQ_SHM_MAGIC || s->version != MLQ_SHM_VERSION || s->size != sizeof(MlqShmState) ||
+        s->num_queues != NUM_QUEUES) {
+        munmap(map, sizeof(MlqShmState));
+        errno = magic == 0 ? EAGAIN : EPROTO;
+        return -1;
+    }
+    *state = s;
+    return 0;
+}
+
+void mlq_shm_unmap(const MlqShmState *state) {
+    munmap((void *)state, sizeof(MlqShmState));
+}
+
+#else
+
+int mlq_shm_create(MlqShm *shm, const char *name, const MlqSim *sim) {
+    memset(shm, 0, sizeof(*shm));
+    errno = ENOSYS;
+    return -1;
+}
+
+void mlq_shm_close(MlqShm *shm) {
+}
+
+int mlq_shm_open(const char *name, const MlqShmState **state) {
+    errno = ENOSYS;
+    return -1;
+}
+
+void mlq_shm_unmap(const MlqShmState *state) {
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef MLQ_SHM_H
+#define MLQ_SHM_H
+
+#include <stdint.h>
+
+#include "mlq_engine.h"
+
+#define MLQ_SHM_MAGIC 0x53514c4du      // "MLQS"
+#define MLQ_SHM_VERSION 1
+#define MLQ_SHM_SLICES 4096             // recent slices kept, a power of two
+#define MLQ_SHM_DEFAULT_NAME "/mlq-live"
+
+// Run-wide counters, as of the latest event
+typedef struct {
+    int32_t run;                // bumped on every reset; slices restart at 0
+    int32_t done;               // the run has finished
+    int32_t cpu_count;
+    int32_t process_count;
+    int32_t finished_count;
+    int32_t current_time;
+    int32_t makespan;
+    int64_t steps;
+} MlqShmStatus;
+
+// One CPU as of the latest event on it
+typedef struct {
+    uint32_t seq;
+    int32_t clock;
+    int32_t running;            // pid of the latest dispatch, busy until clock; -1 idle
+    int32_t running_level;
+    int32_t ready;              // processes on the CPU, the running one included
+    int32_t level_count[NUM_QUEUES];
+} MlqShmCpu;
+
+// Layout of the shared region. The status and each CPU record sit behind
+// their own seqlock: the writer makes seq odd, updates, and makes it even
+// again, and a reader retries a copy that saw an odd or changed seq. The
+// records are small, so a reader gets through even while the engine
+// publishes every event; CPUs are each consistent but not with each
+// other. Slices go to a ring: slice k of the run is at
+// slices[k % MLQ_SHM_SLICES] until slice_count passes k + MLQ_SHM_SLICES.
+typedef struct {
+    uint32_t magic;             // written last, once the rest is set up
+    uint32_t version;
+    uint32_t size;              // bytes in the region
+    int32_t num_queues;
+    int32_t slice_capacity;
+    int32_t writer_pid;
+    uint32_t seq;               // guards status
+    MlqShmStatus status;
+    int64_t slice_count;        // published with release order
+    MlqShmCpu cpus[MLQ_MAX_CPUS];
+    MlqSlice slices[MLQ_SHM_SLICES];
+} MlqShmState;
+
+// Writer side, fed from the engine's event callback on the stepping thread
+typedef struct {
+    MlqShmState *state;
+    const MlqSim *sim;
+    char name[64];
+} MlqShm;
+
+// Create (or take over) the region `name` ("/mlq-live" style) for `sim`.
+// -1 with errno set on failure, or where there is no POSIX shared memory.
+int mlq_shm_create(MlqShm *shm, const char *name, const MlqSim *sim);
+// Unmap and remove the name; readers that have it mapped keep their view
+void mlq_shm_close(MlqShm *shm);
+
+// Start a new run: clears the state and bumps `run`. Call after
+// mlq_sim_reset.
+void mlq_shm_reset(MlqShm *shm);
+// Publish one engine event: its CPU, the status and DISPATCH/IDLE slices.
+// O(1) except for a migration, which refreshes every CPU.
+void mlq_shm_event(MlqShm *shm, const MlqEvent *ev);
+// Mark the run finished
+void mlq_shm_finish(MlqShm *shm);
+
+// Reader side: map `name` read-only. -1 with errno ENOENT if absent,
+// EAGAIN while the writer is still setting it up, EPROTO for another
+// version.
+int mlq_shm_open(const char *name, const MlqShmState **state);
+void mlq_shm_unmap(const MlqShmState *state);
+
+// Consistent copies; they spin only while that record is being written
+void mlq_shm_read_status(const MlqShmState *state, MlqShmStatus *out);
+void mlq_shm_read_cpu(const MlqShmState *state, int cpu, MlqShmCpu *out);
+// Copy slices [from, from + max) of run `run` that are still in the ring.
+// Returns how many, with *first set to the index of out[0] (above `from`
+// if the ring overran); -1 if the writer has moved on to another run.
+int mlq_shm_read_slices(const MlqShmState *state, int run, int64_t from, MlqSlice *out, int max, int64_t *first);
+
+#endif
@@ -0,0 +1,119 @@
+// Reference reader of the live feed: polls the shared region a running
+// `mlq --shm` publishes and prints its state and new slices
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_shm.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [--name NAME] [--interval MS] [--slices] [--wait] [--once]\n"
+            "  --name NAME      shared memory name (default %s)\n"
+            "  --interval MS    poll interval (default 200)\n"
+            "  --slices         also print every new slice\n"
+            "  --wait           wait for the writer to start instead of failing\n"
+            "  --once           print the state once and exit\n",
+            prog, MLQ_SHM_DEFAULT_NAME);
+}
+
+static void sleep_ms(int ms) {
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+static void print_state(const MlqShmState *state, const MlqShmStatus *status) {
+    printf("run %d  time %d  steps %lld  finished %d/%d%s\n", status->run, status->current_time,
+           (long long)status->steps, status->finished_count, status->process_count, status->done ? "  done" : "");
+    for (int c = 0; c < status->cpu_count && c < MLQ_MAX_CPUS; c++) {
+        MlqShmCpu cpu;
+        mlq_shm_read_cpu(state, c, &cpu);
+        printf("  cpu %-3d clock %-10d ", c, cpu.clock);
+        if (cpu.running >= 0) printf("P%-7d L%d ", cpu.running + 1, cpu.running_level);
+        else printf("%-8s    ", "IDLE");
+        printf(" ready %-6d", cpu.ready);
+        for (int q = 0; q < NUM_QUEUES; q++) printf(" L%d:%d", q + 1, cpu.level_count[q]);
+        putchar('\n');
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *name = MLQ_SHM_DEFAULT_NAME;
+    int interval = 200;
+    int slices = 0, wait = 0, once = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--name") == 0 && val) {
+            name = val;
+            i++;
+        } else if (strcmp(arg, "--interval") == 0 && val) {
+            interval = atoi(val);
+            if (interval < 1) interval = 1;
+            i++;
+        } else if (strcmp(arg, "--slices") == 0) {
+            slices = 1;
+        } else if (strcmp(arg, "--wait") == 0) {
+            wait = 1;
+        } else if (strcmp(arg, "--once") == 0) {
+            once = 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    const MlqShmState *state;
+    while (mlq_shm_open(name, &state) < 0) {
+        if (errno == EAGAIN || (wait && errno == ENOENT)) {
+            sleep_ms(interval);
+            continue;
+        }
+        if (errno == EPROTO) fprintf(stderr, "%s: written by an incompatible build\n", name);
+        else perror(name);
+        return 1;
+    }
+
+    MlqSlice batch[MLQ_SHM_SLICES];
+    int run = -1;
+    int64_t next = 0;
+    long long lost = 0;
+    for (;;) {
+        MlqShmStatus status;
+        mlq_shm_read_status(state, &status);
+        if (status.run != run) {
+            run = status.run;
+            next = 0;
+        }
+        // One ring's worth per poll, or everything once the run is done
+        int n;
+        int64_t first;
+        do {
+            n = slices ? mlq_shm_read_slices(state, run, next, batch, MLQ_SHM_SLICES, &first) : 0;
+            if (n <= 0) break;
+            lost += first - next;
+            for (int i = 0; i < n; i++) {
+                const MlqSlice *s = &batch[i];
+                if (s->pid >= 0) printf("slice cpu %d P%d L%d %d+%d\n", s->cpu, s->pid + 1, s->queue_level, s->start_time, s->duration);
+                else printf("slice cpu %d IDLE %d+%d\n", s->cpu, s->start_time, s->duration);
+            }
+            next = first + n;
+        } while (status.done);
+        print_state(state, &status);
+        fflush(stdout);
+
+        // A run that finished or a writer that went away is the end
+        int gone = kill(state->writer_pid, 0) < 0 && errno == ESRCH;
+        if (once || status.done || gone) break;
+        sleep_ms(interval);
+    }
+    if (lost > 0) fprintf(stderr, "%lld slices overwritten before they were read\n", lost);
+    mlq_shm_unmap(state);
+    return 0;
+}
@@ -0,0 +1,312 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_sweep.h"
+#include "mlq_profile.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+void mlq_sweep_spec_from_config(MlqSweepSpec *spec, const MlqConfig *base) {
+    spec->cpus = (MlqRange){base->num_cpus, base->num_cpus, 1};
+    spec->aging = (MlqRange){base->aging_threshold, base->aging_threshold, 1};
+    spec->decrease = (MlqRange){base->decrease_threshold, base->decrease_threshold, 1};
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        spec->time_quantum[q] = (MlqRange){base->time_quantum[q], base->time_quantum[q], 1};
+    }
+    spec->threads = 0;
+}
+
+int mlq_range_parse(MlqRange *range, const char *text) {
+    char *end;
+    range->lo = (int)strtol(text, &end, 10);
+    if (end == text) return -1;
+    range->hi = range->lo;
+    range->step = 1;
+    if (*end == ':') {
+        const char *p = end + 1;
+        range->hi = (int)strtol(p, &end, 10);
+        if (end == p) return -1;
+        if (*end == ':') {
+            p = end + 1;
+            range->step = (int)strtol(p, &end, 10);
+            if (end == p) return -1;
+        }
+    }
+    if (*end != '\0' || range->step <= 0 || range->hi < range->lo) return -1;
+    return 0;
+}
+
+static int range_size(const MlqRange *r) {
+    return (r->hi - r->lo) / r->step + 1;
+}
+
+int mlq_sweep_size(const MlqSweepSpec *spec) {
+    long long n = (long long)range_size(&spec->cpus) * range_size(&spec->aging) * range_size(&spec->decrease);
+    for (int q = 0; q < NUM_QUEUES; q++) n *= range_size(&spec->time_quantum[q]);
+    return n > 0x7fffffff ? -1 : (int)n;
+}
+
+int mlq_online_cpus(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+double mlq_wall_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Grid point `index` in row-major order over (cpus, aging, decrease, tq...)
+static void config_at(const MlqSweepSpec *spec, const MlqConfig *base, int index, MlqConfig *cfg) {
+    *cfg = *base;
+    cfg->record_timeline = 0;
+    for (int q = NUM_QUEUES - 1; q >= 0; q--) {
+        const MlqRange *r = &spec->time_quantum[q];
+        cfg->time_quantum[q] = r->lo + (index % range_size(r)) * r->step;
+        index /= range_size(r);
+    }
+    cfg->decrease_threshold = spec->decrease.lo + (index % range_size(&spec->decrease)) * spec->decrease.step;
+    index /= range_size(&spec->decrease);
+    cfg->aging_threshold = spec->aging.lo + (index % range_size(&spec->aging)) * spec->aging.step;
+    index /= range_size(&spec->aging);
+    cfg->num_cpus = spec->cpus.lo + index * spec->cpus.step;
+}
+
+// k-th smallest value (0-based); reorders the array
+static int select_kth(int *a, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int pivot = a[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                int t = a[i];
+                a[i] = a[j];
+                a[j] = t;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return a[k];
+}
+
+double mlq_p99(int *values, int n) {
+    if (n == 0) return 0;
+    int k = (int)((99LL * n + 99) / 100) - 1;
+    return select_kth(values, n, k);
+}
+
+// Per-task deque: the owner pops from the bottom, thieves take the top
+typedef struct {
+    pthread_mutex_t lock;
+    int *tasks;
+    int top;
+    int bottom;
+} TaskDeque;
+
+typedef struct {
+    const MlqWorkload *wl;
+    const MlqConfig *base;
+    const MlqSweepSpec *spec;
+    MlqSweepResult *results;
+    TaskDeque *deques;
+    int workers;
+} SweepShared;
+
+typedef struct {
+    SweepShared *shared;
+    int id;
+} SweepWorker;
+
+static int deque_pop(TaskDeque *d) {
+    int task = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) task = d->tasks[--d->bottom];
+    pthread_mutex_unlock(&d->lock);
+    return task;
+}
+
+static int deque_steal(TaskDeque *d) {
+    int task = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom > d->top) task = d->tasks[d->top++];
+    pthread_mutex_unlock(&d->lock);
+    return task;
+}
+
+static int next_task(SweepShared *shared, int id) {
+    int task = deque_pop(&shared->deques[id]);
+    for (int k = 1; task < 0 && k < shared->workers; k++) {
+        task = deque_steal(&shared->deques[(id + k) % shared->workers]);
+    }
+    return task;
+}
+
+static void run_task(SweepShared *shared, MlqSim *sim, int *scratch, int task) {
+    MlqSweepResult *r = &shared->results[task];
+    config_at(shared->spec, shared->base, task, &r->config);
+    sim->config = r->config;
+    if (mlq_sim_reset(sim) < 0) {
+        r->failed = 1;
+        return;
+    }
+    mlq_sim_run(sim);
+    if (sim->policy_failed) {
+        r->failed = 1;
+        return;
+    }
+
+    int n = sim->process_count;
+    double sum_tat = 0, sum_wt = 0, sum_rt = 0;
+    for (int i = 0; i < n; i++) {
+        const MlqProcess *p = &sim->processes[i];
+        sum_tat += p->turnaround_time;
+        sum_wt += p->waiting_time;
+        sum_rt += p->response_time;
+    }
+    int div = n > 0 ? n : 1;
+    r->mean_turnaround = sum_tat / div;
+    r->mean_waiting = sum_wt / div;
+    r->mean_response = sum_rt / div;
+
+    for (int i = 0; i < n; i++) scratch[i] = sim->processes[i].turnaround_time;
+    r->p99_turnaround = mlq_p99(scratch, n);
+    for (int i = 0; i < n; i++) scratch[i] = sim->processes[i].waiting_time;
+    r->p99_waiting = mlq_p99(scratch, n);
+    for (int i = 0; i < n; i++) scratch[i] = sim->processes[i].response_time;
+    r->p99_response = mlq_p99(scratch, n);
+
+    r->makespan = sim->makespan;
+    r->throughput = sim->makespan > 0 ? (double)n / sim->makespan : 0;
+    r->steps = sim->steps;
+}
+
+static void *worker_main(void *arg) {
+    SweepWorker *w = arg;
+    SweepShared *shared = w->shared;
+    MLQ_PROF_THREAD("sweep");
+
+    // One simulator per worker, loaded once and reset per configuration
+    MlqSim sim;
+    MlqConfig cfg = *shared->base;
+    cfg.record_timeline = 0;
+    int *scratch = malloc(sizeof(int) * (shared->wl->count > 0 ? shared->wl->count : 1));
+    int ok = scratch && mlq_sim_init(&sim, &cfg) == 0;
+    if (ok && mlq_sim_load_workload(&sim, shared->wl) < 0) {
+        mlq_sim_free(&sim);
+        ok = 0;
+    }
+
+    int task;
+    while ((task = next_task(shared, w->id)) >= 0) {
+        if (ok) run_task(shared, &sim, scratch, task);
+        else shared->results[task].failed = 1;
+    }
+
+    if (ok) mlq_sim_free(&sim);
+    free(scratch);
+    return NULL;
+}
+
+int mlq_sweep_run(const MlqWorkload *wl, const MlqConfig *base, const MlqSweepSpec *spec,
+                  MlqSweepResult **results, int *count) {
+    int total = mlq_sweep_size(spec);
+    if (total <= 0) return -1;
+
+    int workers = spec->threads > 0 ? spec->threads : mlq_online_cpus();
+    if (workers > total) workers = total;
+
+    SweepShared shared = {wl, base, spec, NULL, NULL, workers};
+    shared.results = calloc((size_t)total, sizeof(MlqSweepResult));
+    shared.deques = calloc((size_t)workers, sizeof(TaskDeque));
+    int *tasks = malloc(sizeof(int) * total);
+    pthread_t *threads = malloc(sizeof(pthread_t) * workers);
+    SweepWorker *args = malloc(sizeof(SweepWorker) * workers);
+    if (!shared.results || !shared.deques || !tasks || !threads || !args) {
+        free(shared.results);
+        free(shared.deques);
+        free(tasks);
+        free(threads);
+        free(args);
+        return -1;
+    }
+
+    // Deal contiguous blocks; stealing evens out configs that run longer
+    for (int i = 0; i < total; i++) tasks[i] = i;
+    for (int w = 0; w < workers; w++) {
+        TaskDeque *d = &shared.deques[w];
+        pthread_mutex_init(&d->lock, NULL);
+        d->tasks = tasks;
+        d->top = (int)((long long)total * w / workers);
+        d->bottom = (int)((long long)total * (w + 1) / workers);
+    }
+
+    int started = 0;
+    for (int w = 0; w < workers; w++) {
+        args[w].shared = &shared;
+        args[w].id = w;
+        if (pthread_create(&threads[w], NULL, worker_main, &args[w]) != 0) break;
+        started++;
+    }
+    // If thread creation failed part way, finish the rest on this thread
+    if (started < workers) {
+        SweepWorker self = {&shared, started};
+        worker_main(&self);
+    }
+    for (int w = 0; w < started; w++) pthread_join(threads[w], NULL);
+
+    for (int w = 0; w < workers; w++) pthread_mutex_destroy(&shared.deques[w].lock);
+    free(shared.deques);
+    free(tasks);
+    free(threads);
+    free(args);
+
+    *results = shared.results;
+    *count = total;
+    return 0;
+}
+
+void mlq_sweep_write_csv(FILE *out, const MlqSweepResult *results, int count) {
+    fprintf(out, "cpus,aging,decrease");
+    for (int q = 0; q < NUM_QUEUES; q++) fprintf(out, ",tq%d", q + 1);
+    fprintf(out, ",mean_turnaround,p99_turnaround,mean_waiting,p99_waiting,"
+                 "mean_response,p99_response,makespan,throughput,steps\n");
+
+    for (int i = 0; i < count; i++) {
+        const MlqSweepResult *r = &results[i];
+        if (r->failed) continue;
+        fprintf(out, "%d,%d,%d", r->config.num_cpus, r->config.aging_threshold, r->config.decrease_threshold);
+        for (int q = 0; q < NUM_QUEUES; q++) fprintf(out, ",%d", r->config.time_quantum[q]);
+        fprintf(out, ",%.3f,%.0f,%.3f,%.0f,%.3f,%.0f,%d,%.4f,%lld\n",
+                r->mean_turnaround, r->p99_turnaround, r->mean_waiting, r->p99_waiting,
+                r->mean_response, r->p99_response, r->makespan, r->throughput, r->steps);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef MLQ_SWEEP_H
+#define MLQ_SWEEP_H
+
+#include <stdio.h>
+
+#include "mlq_engine.h"
+#include "mlq_workload.h"
+
+// Inclusive integer range lo, lo + step, ..., hi
+typedef struct {
+    int lo;
+    int hi;
+    int step;
+} MlqRange;
+
+// Grid of configurations to try; unset ranges hold the base value
+typedef struct {
+    MlqRange cpus;
+    MlqRange aging;
+    MlqRange decrease;
+    MlqRange time_quantum[NUM_QUEUES];
+    int threads;                // 0 = one per online CPU
+} MlqSweepSpec;
+
+typedef struct {
+    MlqConfig config;
+    double mean_turnaround;
+    double p99_turnaround;
+    double mean_waiting;
+    double p99_waiting;
+    double mean_response;
+    double p99_response;
+    int makespan;
+    double throughput;          // completions per tick of makespan
+    long long steps;
+    int failed;
+} MlqSweepResult;
+
+// Single-value ranges taken from the base configuration
+void mlq_sweep_spec_from_config(MlqSweepSpec *spec, const MlqConfig *base);
+
+// "lo:hi[:step]" or a single value
+int mlq_range_parse(MlqRange *range, const char *text);
+
+int mlq_sweep_size(const MlqSweepSpec *spec);
+int mlq_online_cpus(void);
+double mlq_wall_seconds(void);     // monotonic clock for timing runs
+
+// Nearest-rank 99th percentile; reorders the array
+double mlq_p99(int *values, int n);
+
+// Runs every configuration of the grid on its own simulator context over a
+// work-stealing thread pool. *results is malloc'ed, one entry per grid point.
+int mlq_sweep_run(const MlqWorkload *wl, const MlqConfig *base, const MlqSweepSpec *spec,
+                  MlqSweepResult **results, int *count);
+
+void mlq_sweep_write_csv(FILE *out, const MlqSweepResult *results, int count);
+
+#endif
@@ -0,0 +1,292 @@
+// Differential test of the aging paths: fixed workloads are run with lazy
+// deadline aging, with the per-step counter pass (eager_aging), and, on
+// one CPU, through a plain model of the original counter-based step loop.
+// Exits 1 on any difference.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mlq_engine.h"
+#include "mlq_workload.h"
+
+// The original step_simulation() on FIFO queues: every step bumps the
+// waiting counter of each queued process and demotes at the threshold,
+// then runs the head of the highest non-empty level for one quantum
+typedef struct {
+    int arrival;
+    int remaining, level, waited, executing;
+    int completion, response, started;
+} RefProcess;
+
+typedef struct {
+    int *slots;                 // pids, oldest first
+    int count;
+} RefQueue;
+
+static void ref_push(RefQueue *q, int pid) {
+    q->slots[q->count++] = pid;
+}
+
+static void ref_remove(RefQueue *q, int pid) {
+    int i = 0;
+    while (q->slots[i] != pid) i++;
+    memmove(q->slots + i, q->slots + i + 1, sizeof(int) * (q->count - i - 1));
+    q->count--;
+}
+
+static const RefProcess *sort_procs;
+
+static int compare_arrival(const void *a, const void *b) {
+    const RefProcess *x = &sort_procs[*(const int *)a];
+    const RefProcess *y = &sort_procs[*(const int *)b];
+    if (x->arrival != y->arrival) return x->arrival < y->arrival ? -1 : 1;
+    return *(const int *)a - *(const int *)b;
+}
+
+static int ref_run(RefProcess *procs, int n, const MlqConfig *cfg) {
+    int *order = malloc(sizeof(int) * (n > 0 ? n : 1));
+    int *slots = malloc(sizeof(int) * NUM_QUEUES * (n > 0 ? n : 1));
+    if (!order || !slots) {
+        free(order);
+        free(slots);
+        return -1;
+    }
+    RefQueue queues[NUM_QUEUES];
+    for (int q = 0; q < NUM_QUEUES; q++) {
+        queues[q].slots = slots + q * n;
+        queues[q].count = 0;
+    }
+    for (int i = 0; i < n; i++) order[i] = i;
+    sort_procs = procs;
+    qsort(order, n, sizeof(int), compare_arrival);
+
+    int threshold = cfg->decrease_threshold > 1 ? cfg->decrease_threshold : 1;
+    int now = 0, admitted = 0, finished = 0;
+    while (finished < n) {
+        while (admitted < n && procs[order[admitted]].arrival <= now) {
+            int pid = order[admitted++];
+            RefProcess *p = &procs[pid];
+            if (p->remaining <= 0) {
+                finished++;
+                continue;
+            }
+            p->waited = 0;
+            ref_push(&queues[p->level - 1], pid);
+        }
+        int ready = 0;
+        for (int q = 0; q < NUM_QUEUES; q++) ready += queues[q].count;
+        if (ready == 0) {
+            if (admitted == n) break;
+            now = procs[order[admitted]].arrival;
+            continue;
+        }
+
+        // Counters in arrival order, as the original scanned its table
+        for (int r = 0; r < admitted; r++) {
+            RefProcess *p = &procs[order[r]];
+            if (p->remaining <= 0) continue;
+            if (++p->waited >= threshold && p->level < NUM_QUEUES) {
+                ref_remove(&queues[p->level - 1], order[r]);
+                p->level++;
+                p->waited = 0;
+                p->executing = 0;
+                ref_push(&queues[p->level - 1], order[r]);
+            }
+        }
+
+        int level = 1;
+        while (queues[level - 1].count == 0) level++;
+        int pid = queues[level - 1].slots[0];
+        ref_remove(&queues[level - 1], pid);
+        RefProcess *p = &procs[pid];
+        int tq = cfg->time_quantum[level - 1] > 1 ? cfg->time_quantum[level - 1] : 1;
+        int exec_time = tq < p->remaining ? tq : p->remaining;
+        if (!p->started) {
+            p->response = now - p->arrival;
+            p->started = 1;
+        }
+        p->remaining -= exec_time;
+        p->executing += exec_time;
+        p->waited = 0;
+        now += exec_time;
+        if (p->executing >= cfg->aging_threshold && p->level > 1 && p->remaining > 0) {
+            p->level--;
+            p->executing = 0;
+        }
+        if (p->remaining == 0) {
+            p->completion = now;
+            finished++;
+        } else {
+            ref_push(&queues[p->level - 1], pid);
+        }
+    }
+    free(order);
+    free(slots);
+    return 0;
+}
+
+typedef struct {
+    const char *name;
+    int count;
+    double mean_gap;
+    int aging;
+    int decrease;
+    int tq[NUM_QUEUES];
+} TestCase;
+
+static const TestCase cases[] = {
+    {"defaults", 0, 0, 5, 3, {2, 4, 8}},
+    {"small", 50, 4, 5, 3, {2, 4, 8}},
+    {"overload", 2000, 0.5, 5, 3, {2, 4, 8}},
+    {"sparse", 500, 32, 5, 3, {2, 4, 8}},
+    {"eager-demote", 1000, 1, 8, 1, {1, 2, 4}},
+    {"fast-aging", 1000, 2, 1, 4, {4, 8, 16}},
+    {"long-quanta", 1000, 4, 6, 6, {8, 16, 32}},
+};
+
+typedef struct {
+    const char *name;
+    int cpus;
+    MlqBalance balance;
+    int preempt;
+} TestMode;
+
+static const TestMode modes[] = {
+    {"1 cpu", 1, MLQ_BALANCE_NONE, 0},
+    {"1 cpu preempt", 1, MLQ_BALANCE_NONE, 1},
+    {"4 cpus", 4, MLQ_BALANCE_NONE, 0},
+    {"4 cpus balanced", 4, MLQ_BALANCE_BOTH, 0},
+    {"4 cpus balanced preempt", 4, MLQ_BALANCE_BOTH, 1},
+};
+
+static int load_case(MlqSim *sim, const TestCase *tc, uint64_t seed) {
+    if (tc->count == 0) {
+        mlq_sim_add_default_processes(sim);
+        return 0;
+    }
+    MlqGenParams gen;
+    mlq_gen_params_default(&gen);
+    gen.seed = seed;
+    gen.count = tc->count;
+    gen.mean_interarrival = tc->mean_gap;
+    gen.burst_max = 200;
+
+    MlqWorkload wl;
+    mlq_workload_init(&wl);
+    int rc = mlq_workload_generate(&wl, &gen) < 0 || mlq_sim_load_workload(sim, &wl) < 0 ? -1 : 0;
+    mlq_workload_free(&wl);
+    return rc;
+}
+
+static int run_mode(MlqSim *sim, const TestCase *tc, const TestMode *mode, int eager, uint64_t seed) {
+    MlqConfig cfg;
+    mlq_config_default(&cfg);
+    cfg.aging_threshold = tc->aging;
+    cfg.decrease_threshold = tc->decrease;
+    memcpy(cfg.time_quantum, tc->tq, sizeof(cfg.time_quantum));
+    cfg.record_timeline = 0;
+    cfg.num_cpus = mode->cpus;
+    cfg.balance = mode->balance;
+    cfg.preempt = mode->preempt;
+    cfg.eager_aging = eager;
+    if (mlq_sim_init(sim, &cfg) < 0) return -1;
+    if (load_case(sim, tc, seed) < 0) {
+        mlq_sim_free(sim);
+        return -1;
+    }
+    mlq_sim_run(sim);
+    return 0;
+}
+
+// Report up to a few differing processes; returns how many differ
+static int compare(const char *what, const MlqSim *sim, const int *completion, const int *response, int n) {
+    int mismatches = 0;
+    for (int i = 0; i < n; i++) {
+        const MlqProcess *p = &sim->processes[i];
+        if (p->completion_time == completion[i] && p->response_time == response[i]) continue;
+        if (mismatches < 3) {
+            char name[16];
+            mlq_process_name(i, name, sizeof(name));
+            fprintf(stderr, "    %s: %s CT/RT %d/%d, expected %d/%d\n", what, name, p->completion_time,
+                    p->response_time, completion[i], response[i]);
+        }
+        mismatches++;
+    }
+    return mismatches;
+}
+
+static int run_case(const TestCase *tc, const TestMode *mode, uint64_t seed) {
+    MlqSim lazy, eager;
+    if (run_mode(&lazy, tc, mode, 0, seed) < 0) return -1;
+    if (run_mode(&eager, tc, mode, 1, seed) < 0) {
+        mlq_sim_free(&lazy);
+        return -1;
+    }
+
+    int n = eager.process_count;
+    int *completion = malloc(sizeof(int) * (n > 0 ? n : 1));
+    int *response = malloc(sizeof(int) * (n > 0 ? n : 1));
+    RefProcess *ref = malloc(sizeof(RefProcess) * (n > 0 ? n : 1));
+    int failed = -1;
+    if (completion && response && ref) {
+        failed = 0;
+        for (int i = 0; i < n; i++) {
+            completion[i] = eager.processes[i].completion_time;
+            response[i] = eager.processes[i].response_time;
+        }
+        if (lazy.policy_failed || eager.policy_failed) {
+            fprintf(stderr, "    run queue allocation failed\n");
+            failed++;
+        }
+        if (lazy.makespan != eager.makespan || lazy.steps != eager.steps) {
+            fprintf(stderr, "    lazy: makespan/steps %d/%lld, eager %d/%lld\n", lazy.makespan, lazy.steps,
+                    eager.makespan, eager.steps);
+            failed++;
+        }
+        failed += compare("lazy", &lazy, completion, response, n);
+
+        if (mode->cpus == 1 && !mode->preempt) {
+            memset(ref, 0, sizeof(RefProcess) * n);
+            for (int i = 0; i < n; i++) {
+                const MlqProcess *p = &eager.processes[i];
+                ref[i].arrival = p->arrival_time;
+                ref[i].remaining = p->burst_time;
+                ref[i].level = p->original_priority;
+            }
+            if (ref_run(ref, n, &eager.config) < 0) {
+                failed = -1;
+            } else {
+                for (int i = 0; i < n; i++) {
+                    completion[i] = ref[i].completion;
+                    response[i] = ref[i].response;
+                }
+                failed += compare("eager vs original", &eager, completion, response, n);
+            }
+        }
+    }
+    free(completion);
+    free(response);
+    free(ref);
+    mlq_sim_free(&lazy);
+    mlq_sim_free(&eager);
+    return failed;
+}
+
+int main(void) {
+    int run = 0, failures = 0;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+            int seeds = cases[c].count == 0 ? 1 : 3;
+            for (int s = 1; s <= seeds; s++) {
+                int rc = run_case(&cases[c], &modes[m], (uint64_t)s);
+                run++;
+                if (rc == 0) continue;
+                failures++;
+                fprintf(stderr, "FAIL %s, %s, seed %d%s\n", cases[c].name, modes[m].name, s,
+                        rc < 0 ? ": out of memory" : "");
+            }
+        }
+    }
+    printf("%d of %d runs differ\n", failures, run);
+    return failures > 0 ? 1 : 0;
+}
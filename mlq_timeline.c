@@ -0,0 +1,194 @@
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_timeline.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_BYTES (sizeof(MlqSlice) * MLQ_TIMELINE_CHUNK)
+
+// Spill file header; chunk i starts at HEADER_BYTES + i * CHUNK_BYTES
+typedef struct {
+    char magic[4];              // "MLQT"
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t chunk_records;
+    int64_t count;
+} SpillHeader;
+
+#define HEADER_BYTES ((long long)sizeof(SpillHeader))
+
+static int seek_to(FILE *f, long long offset) {
+#ifdef _WIN32
+    return _fseeki64(f, offset, SEEK_SET);
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET);
+#endif
+}
+
+int mlq_timeline_init(MlqTimeline *tl, size_t memory_budget, const char *spill_path) {
+    memset(tl, 0, sizeof(*tl));
+    tl->memory_budget = memory_budget;
+    tl->cache_chunk = -1;
+
+    if (spill_path) {
+        tl->spill = fopen(spill_path, "w+b");
+        if (!tl->spill) return -1;
+    }
+    return 0;
+}
+
+void mlq_timeline_free(MlqTimeline *tl) {
+    for (int i = 0; i < tl->chunk_count; i++) free(tl->chunks[i]);
+    free(tl->chunks);
+    free(tl->cache);
+    free(tl->open);
+    if (tl->spill) fclose(tl->spill);
+    memset(tl, 0, sizeof(*tl));
+}
+
+void mlq_timeline_clear(MlqTimeline *tl) {
+    for (int i = 0; i < tl->chunk_count; i++) free(tl->chunks[i]);
+    tl->chunk_count = 0;
+    tl->count = 0;
+    tl->resident_chunks = 0;
+    tl->oldest_resident = 0;
+    tl->cache_chunk = -1;
+    tl->lane_count = 0;
+}
+
+static int write_header(MlqTimeline *tl) {
+    SpillHeader h;
+    memcpy(h.magic, "MLQT", 4);
+    h.version = 2;
+    h.record_size = sizeof(MlqSlice);
+    h.chunk_records = MLQ_TIMELINE_CHUNK;
+    h.count = tl->count;
+    if (seek_to(tl->spill, 0) != 0) return -1;
+    return fwrite(&h, sizeof(h), 1, tl->spill) == 1 ? 0 : -1;
+}
+
+static int write_chunk(MlqTimeline *tl, int chunk, size_t records) {
+    if (!tl->spill) {
+        tl->spill = tmpfile();
+        if (!tl->spill) return -1;
+    }
+    if (chunk == 0 && write_header(tl) < 0) return -1;
+    if (seek_to(tl->spill, HEADER_BYTES + (long long)chunk * CHUNK_BYTES) != 0) return -1;
+    return fwrite(tl->chunks[chunk], sizeof(MlqSlice), records, tl->spill) == records ? 0 : -1;
+}
+
+// Move the oldest full chunks to disk until we are back under budget
+static int enforce_budget(MlqTimeline *tl) {
+    if (tl->memory_budget == 0) return 0;
+    while ((size_t)tl->resident_chunks * CHUNK_BYTES > tl->memory_budget &&
+           tl->oldest_resident < tl->chunk_count - 1) {
+        int chunk = tl->oldest_resident;
+        if (write_chunk(tl, chunk, MLQ_TIMELINE_CHUNK) < 0) return -1;
+        free(tl->chunks[chunk]);
+        tl->chunks[chunk] = NULL;
+        tl->resident_chunks--;
+        tl->oldest_resident++;
+    }
+    return 0;
+}
+
+static int commit(MlqTimeline *tl, const MlqSlice *slice) {
+    if (tl->count == (long long)tl->chunk_count * MLQ_TIMELINE_CHUNK) {
+        if (tl->chunk_count == tl->chunk_capacity) {
+            int cap = tl->chunk_capacity ? tl->chunk_capacity * 2 : 16;
+            MlqSlice **grown = realloc(tl->chunks, sizeof(MlqSlice *) * cap);
+            if (!grown) return -1;
+            tl->chunks = grown;
+            tl->chunk_capacity = cap;
+        }
+        MlqSlice *chunk = malloc(CHUNK_BYTES);
+        if (!chunk) return -1;
+        tl->chunks[tl->chunk_count++] = chunk;
+        tl->resident_chunks++;
+        if (enforce_budget(tl) < 0) return -1;
+    }
+
+    tl->chunks[tl->chunk_count - 1][tl->count % MLQ_TIMELINE_CHUNK] = *slice;
+    tl->count++;
+    return 0;
+}
+
+int mlq_timeline_append(MlqTimeline *tl, int cpu, int pid, int start_time, int duration, int queue_level) {
+    if (cpu >= tl->lane_count) {
+        MlqSlice *grown = realloc(tl->open, sizeof(MlqSlice) * (cpu + 1));
+        if (!grown) return -1;
+        for (int i = tl->lane_count; i <= cpu; i++) grown[i].duration = 0;
+        tl->open = grown;
+        tl->lane_count = cpu + 1;
+    }
+
+    // Extend the lane's open slice when this one continues it
+    MlqSlice *open = &tl->open[cpu];
+    if (open->duration > 0 && open->pid == pid && open->queue_level == queue_level &&
+        open->start_time + open->duration == start_time) {
+        open->duration += duration;
+        return 0;
+    }
+
+    if (open->duration > 0 && commit(tl, open) < 0) return -1;
+    open->pid = pid;
+    open->start_time = start_time;
+    open->duration = duration;
+    open->queue_level = (short)queue_level;
+    open->cpu = (short)cpu;
+    return 0;
+}
+
+int mlq_timeline_open_slice(const MlqTimeline *tl, int cpu, MlqSlice *out) {
+    if (cpu < 0 || cpu >= tl->lane_count || tl->open[cpu].duration <= 0) return -1;
+    *out = tl->open[cpu];
+    return 0;
+}
+
+int mlq_timeline_get(MlqTimeline *tl, long long index, MlqSlice *out) {
+    if (index < 0 || index >= tl->count) return -1;
+    int chunk = (int)(index / MLQ_TIMELINE_CHUNK);
+    int offset = (int)(index % MLQ_TIMELINE_CHUNK);
+
+    if (tl->chunks[chunk]) {
+        *out = tl->chunks[chunk][offset];
+        return 0;
+    }
+
+    if (tl->cache_chunk != chunk) {
+        if (!tl->cache) {
+            tl->cache = malloc(CHUNK_BYTES);
+            if (!tl->cache) return -1;
+        }
+        if (seek_to(tl->spill, HEADER_BYTES + (long long)chunk * CHUNK_BYTES) != 0 ||
+            fread(tl->cache, sizeof(MlqSlice), MLQ_TIMELINE_CHUNK, tl->spill) != MLQ_TIMELINE_CHUNK) {
+            tl->cache_chunk = -1;
+            return -1;
+        }
+        tl->cache_chunk = chunk;
+    }
+    *out = tl->cache[offset];
+    return 0;
+}
+
+int mlq_timeline_flush(MlqTimeline *tl) {
+    for (int cpu = 0; cpu < tl->lane_count; cpu++) {
+        MlqSlice *open = &tl->open[cpu];
+        if (open->duration > 0 && commit(tl, open) < 0) return -1;
+        open->duration = 0;
+    }
+
+    for (int i = tl->oldest_resident; i < tl->chunk_count; i++) {
+        size_t records = MLQ_TIMELINE_CHUNK;
+        if (i == tl->chunk_count - 1) records = (size_t)(tl->count - (long long)i * MLQ_TIMELINE_CHUNK);
+        if (write_chunk(tl, i, records) < 0) return -1;
+    }
+    if (tl->spill) {
+        if (write_header(tl) < 0) return -1;
+        if (fflush(tl->spill) != 0) return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef MLQ_TIMELINE_H
+#define MLQ_TIMELINE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// One Gantt chart slice; pid is -1 for IDLE
+typedef struct {
+    int pid;
+    int start_time;
+    int duration;
+    short queue_level;
+    short cpu;                  // lane of the chart
+} MlqSlice;
+
+#define MLQ_TIMELINE_CHUNK 4096     // slices per chunk (64 KiB)
+
+// Growable slice store. Each CPU lane holds one open slice; back-to-back
+// slices of the same process and level extend it, anything else commits it
+// to the store. Once the resident chunks exceed memory_budget the oldest
+// full chunks are written to the spill file and read back on demand.
+typedef struct {
+    MlqSlice **chunks;          // NULL once a chunk lives only on disk
+    int chunk_count;
+    int chunk_capacity;
+    long long count;            // committed records
+
+    MlqSlice *open;             // per-lane slice still being extended
+    int lane_count;
+
+    size_t memory_budget;       // bytes of resident chunks, 0 = unlimited
+    int resident_chunks;
+    int oldest_resident;        // chunks below this index are spilled
+
+    FILE *spill;
+
+    MlqSlice *cache;            // one spilled chunk read back for get()
+    int cache_chunk;
+} MlqTimeline;
+
+// spill_path may be NULL for an anonymous temporary file
+int mlq_timeline_init(MlqTimeline *tl, size_t memory_budget, const char *spill_path);
+void mlq_timeline_free(MlqTimeline *tl);
+void mlq_timeline_clear(MlqTimeline *tl);
+
+int mlq_timeline_append(MlqTimeline *tl, int cpu, int pid, int start_time, int duration, int queue_level);
+int mlq_timeline_get(MlqTimeline *tl, long long index, MlqSlice *out);
+
+// The lane's open slice, not yet in the store; returns -1 if there is none
+int mlq_timeline_open_slice(const MlqTimeline *tl, int cpu, MlqSlice *out);
+
+// Commit the open slices and write every chunk, including the resident
+// ones, so the spill file holds the complete history (header + records)
+int mlq_timeline_flush(MlqTimeline *tl);
+
+#endif
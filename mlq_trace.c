@@ -0,0 +1,352 @@
+#include "mlq_trace.h"
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef MLQ_ZLIB
+#include <zlib.h>
+#endif
+
+#define ARRIVALS_TRACK MLQ_MAX_CPUS     // JSON tid, Perfetto uuid - 1; CPU c is c
+#define NS_PER_TICK 1000
+#define SEQUENCE_ID 1
+
+// Perfetto field numbers (protos/perfetto/trace)
+#define TRACE_PACKET 1
+#define PACKET_TIMESTAMP 8
+#define PACKET_SEQUENCE_ID 10
+#define PACKET_TRACK_EVENT 11
+#define PACKET_INTERNED_DATA 12
+#define PACKET_SEQUENCE_FLAGS 13
+#define PACKET_TRACK_DESCRIPTOR 60
+#define DESCRIPTOR_UUID 1
+#define DESCRIPTOR_NAME 2
+#define EVENT_ANNOTATIONS 4
+#define EVENT_TYPE 9
+#define EVENT_NAME_IID 10
+#define EVENT_TRACK_UUID 11
+#define INTERNED_EVENT_NAMES 2
+#define INTERNED_ANNOTATION_NAMES 3
+#define ANNOTATION_NAME_IID 1
+#define ANNOTATION_INT 4
+#define ANNOTATION_STRING 6
+
+#define SEQ_INCREMENTAL_STATE_CLEARED 1
+#define SEQ_NEEDS_INCREMENTAL_STATE 2
+#define TYPE_SLICE_BEGIN 1
+#define TYPE_SLICE_END 2
+#define TYPE_INSTANT 3
+
+// Interned event names; process i is NAME_FIRST_PID + i
+enum { NAME_IDLE = 1, NAME_PROMOTE, NAME_DEMOTE, NAME_COMPLETE, NAME_MIGRATE, NAME_PREEMPT, NAME_FIRST_PID = 16 };
+enum { ANNOTATION_PROCESS = 1, ANNOTATION_LEVEL };
+
+static const char *fixed_names[] = {NULL, "IDLE", "promote", "demote", "complete", "migrate", "preempt"};
+
+int mlq_trace_can_compress(void) {
+#ifdef MLQ_ZLIB
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int mlq_trace_parse_format(const char *name, MlqTraceFormat *format) {
+    if (strcmp(name, "json") == 0) *format = MLQ_TRACE_JSON;
+    else if (strcmp(name, "perfetto") == 0) *format = MLQ_TRACE_PERFETTO;
+    else return -1;
+    return 0;
+}
+
+static void flush_buffer(MlqTrace *t) {
+    if (t->len > 0 && !t->failed) {
+#ifdef MLQ_ZLIB
+        if (t->gz) {
+            if (gzwrite((gzFile)t->gz, t->buf, (unsigned)t->len) != (int)t->len) t->failed = 1;
+        } else
+#endif
+        if (fwrite(t->buf, 1, t->len, t->file) != t->len) {
+            t->failed = 1;
+        }
+    }
+    t->len = 0;
+}
+
+// Room for `size` more bytes at the end of the buffer
+static unsigned char *reserve(MlqTrace *t, size_t size) {
+    if (t->len + size > MLQ_TRACE_BUFFER) flush_buffer(t);
+    return t->buf + t->len;
+}
+
+// One JSON event, comma-separated from the previous one
+static void json_event(MlqTrace *t, const char *fmt, ...) {
+    char *out = (char *)reserve(t, 512);
+    int n = t->first ? 0 : 2;
+    if (!t->first) memcpy(out, ",\n", 2);
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(out + n, 512 - n, fmt, ap);
+    va_end(ap);
+    if (len < 0) return;
+    t->len += n + (len < 512 - n ? len : 511 - n);
+    t->first = 0;
+}
+
+static void json_header(MlqTrace *t) {
+    const char *head = "{\"traceEvents\":[\n";
+    memcpy(reserve(t, strlen(head)), head, strlen(head));
+    t->len += strlen(head);
+    t->first = 1;
+    json_event(t, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"MLQ scheduler\"}}");
+    for (int c = 0; c < t->sim->cpu_count; c++) {
+        json_event(t, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"CPU %d\"}}", c, c);
+    }
+    json_event(t, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"arrivals\"}}",
+               ARRIVALS_TRACK);
+}
+
+static void json_write(MlqTrace *t, const MlqEvent *ev) {
+    static const char *instants[] = {NULL, "promote", "demote", "complete", NULL, "migrate", NULL, "preempt"};
+    char name[16];
+    mlq_process_name(ev->pid, name, sizeof(name));
+    switch (ev->kind) {
+        case MLQ_EV_DISPATCH:
+            json_event(t, "{\"name\":\"%s\",\"cat\":\"Q%d\",\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":1,\"tid\":%d}",
+                       name, ev->queue_level, ev->time, ev->duration, ev->cpu);
+            break;
+        case MLQ_EV_IDLE:
+            json_event(t, "{\"name\":\"IDLE\",\"cat\":\"idle\",\"ph\":\"X\",\"ts\":%d,\"dur\":%d,\"pid\":1,\"tid\":%d}",
+                       ev->time, ev->duration, ev->cpu);
+            break;
+        case MLQ_EV_ARRIVE:
+            json_event(t, "{\"name\":\"%s\",\"cat\":\"arrive\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%d,\"pid\":1,\"tid\":%d,"
+                          "\"args\":{\"level\":%d,\"cpu\":%d}}",
+                       name, ev->time, ARRIVALS_TRACK, ev->queue_level, ev->cpu);
+            break;
+        case MLQ_EV_PROMOTE:
+        case MLQ_EV_DEMOTE:
+        case MLQ_EV_COMPLETE:
+        case MLQ_EV_MIGRATE:
+        case MLQ_EV_PREEMPT:
+            json_event(t, "{\"name\":\"%s\",\"cat\":\"level\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%d,\"pid\":1,\"tid\":%d,"
+                          "\"args\":{\"process\":\"%s\",\"level\":%d}}",
+                       instants[ev->kind], ev->time, ev->cpu, name, ev->queue_level);
+            break;
+    }
+}
+
+// Protobuf message under construction; every message here is small
+typedef struct {
+    unsigned char data[256];
+    size_t len;
+} Pb;
+
+static void pb_varint(Pb *pb, uint64_t v) {
+    while (v >= 0x80 && pb->len < sizeof(pb->data)) {
+        pb->data[pb->len++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    if (pb->len < sizeof(pb->data)) pb->data[pb->len++] = (unsigned char)v;
+}
+
+static void pb_uint(Pb *pb, int field, uint64_t v) {
+    pb_varint(pb, (uint64_t)field << 3);
+    pb_varint(pb, v);
+}
+
+static void pb_bytes(Pb *pb, int field, const void *data, size_t len) {
+    pb_varint(pb, ((uint64_t)field << 3) | 2);
+    pb_varint(pb, len);
+    if (len > sizeof(pb->data) - pb->len) len = sizeof(pb->data) - pb->len;
+    memcpy(pb->data + pb->len, data, len);
+    pb->len += len;
+}
+
+static void pb_string(Pb *pb, int field, const char *s) {
+    pb_bytes(pb, field, s, strlen(s));
+}
+
+static void pb_message(Pb *pb, int field, const Pb *sub) {
+    pb_bytes(pb, field, sub->data, sub->len);
+}
+
+// An EventName or DebugAnnotationName entry of InternedData
+static void pb_interned(Pb *pb, int field, uint64_t iid, const char *name) {
+    Pb entry = {{0}, 0};
+    pb_uint(&entry, 1, iid);
+    pb_string(&entry, 2, name);
+    pb_message(pb, field, &entry);
+}
+
+static void write_packet(MlqTrace *t, const Pb *packet) {
+    Pb head = {{0}, 0};
+    pb_varint(&head, ((uint64_t)TRACE_PACKET << 3) | 2);
+    pb_varint(&head, packet->len);
+    unsigned char *out = reserve(t, head.len + packet->len);
+    memcpy(out, head.data, head.len);
+    memcpy(out + head.len, packet->data, packet->len);
+    t->len += head.len + packet->len;
+}
+
+static void perfetto_header(MlqTrace *t) {
+    Pb packet = {{0}, 0}, interned = {{0}, 0};
+    for (int i = NAME_IDLE; i <= NAME_PREEMPT; i++) pb_interned(&interned, INTERNED_EVENT_NAMES, i, fixed_names[i]);
+    pb_interned(&interned, INTERNED_ANNOTATION_NAMES, ANNOTATION_PROCESS, "process");
+    pb_interned(&interned, INTERNED_ANNOTATION_NAMES, ANNOTATION_LEVEL, "level");
+    pb_uint(&packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+    pb_uint(&packet, PACKET_SEQUENCE_FLAGS, SEQ_INCREMENTAL_STATE_CLEARED);
+    pb_message(&packet, PACKET_INTERNED_DATA, &interned);
+    write_packet(t, &packet);
+
+    for (int c = 0; c <= t->sim->cpu_count; c++) {
+        Pb desc = {{0}, 0};
+        char name[16];
+        int track = c < t->sim->cpu_count ? c : ARRIVALS_TRACK;
+        if (track == ARRIVALS_TRACK) strcpy(name, "arrivals");
+        else snprintf(name, sizeof(name), "CPU %d", c);
+        pb_uint(&desc, DESCRIPTOR_UUID, (uint64_t)track + 1);
+        pb_string(&desc, DESCRIPTOR_NAME, name);
+        packet.len = 0;
+        pb_message(&packet, PACKET_TRACK_DESCRIPTOR, &desc);
+        write_packet(t, &packet);
+    }
+}
+
+// Whether the process's name still has to be interned; marks it done
+static int needs_name(MlqTrace *t, int pid) {
+    if (pid >= t->named_capacity) {
+        int cap = t->named_capacity ? t->named_capacity : 1024;
+        while (cap <= pid) cap *= 2;
+        unsigned char *grown = realloc(t->named, (size_t)cap);
+        if (!grown) return 1;
+        memset(grown + t->named_capacity, 0, (size_t)(cap - t->named_capacity));
+        t->named = grown;
+        t->named_capacity = cap;
+    }
+    if (t->named[pid]) return 0;
+    t->named[pid] = 1;
+    return 1;
+}
+
+// A TrackEvent packet; intern_pid >= 0 adds that process's name first
+static void perfetto_packet(MlqTrace *t, int time, const Pb *event, int intern_pid) {
+    Pb packet = {{0}, 0};
+    pb_uint(&packet, PACKET_TIMESTAMP, (uint64_t)time * NS_PER_TICK);
+    pb_uint(&packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+    pb_uint(&packet, PACKET_SEQUENCE_FLAGS, SEQ_NEEDS_INCREMENTAL_STATE);
+    if (intern_pid >= 0) {
+        Pb interned = {{0}, 0};
+        char name[16];
+        mlq_process_name(intern_pid, name, sizeof(name));
+        pb_interned(&interned, INTERNED_EVENT_NAMES, NAME_FIRST_PID + (uint64_t)intern_pid, name);
+        pb_message(&packet, PACKET_INTERNED_DATA, &interned);
+    }
+    pb_message(&packet, PACKET_TRACK_EVENT, event);
+    write_packet(t, &packet);
+}
+
+static void pb_annotation(Pb *event, int name_iid, const char *string_value, long long int_value) {
+    Pb note = {{0}, 0};
+    pb_uint(&note, ANNOTATION_NAME_IID, name_iid);
+    if (string_value) pb_string(&note, ANNOTATION_STRING, string_value);
+    else pb_uint(&note, ANNOTATION_INT, (uint64_t)int_value);
+    pb_message(event, EVENT_ANNOTATIONS, &note);
+}
+
+static void perfetto_write(MlqTrace *t, const MlqEvent *ev) {
+    static const int instants[] = {0, NAME_PROMOTE, NAME_DEMOTE, NAME_COMPLETE, 0, NAME_MIGRATE, 0, NAME_PREEMPT};
+    Pb event = {{0}, 0};
+    uint64_t track = (uint64_t)(ev->kind == MLQ_EV_ARRIVE ? ARRIVALS_TRACK : ev->cpu) + 1;
+    int intern = -1;
+    char name[16];
+
+    switch (ev->kind) {
+        case MLQ_EV_DISPATCH:
+        case MLQ_EV_IDLE:
+            if (ev->kind == MLQ_EV_DISPATCH && needs_name(t, ev->pid)) intern = ev->pid;
+            pb_uint(&event, EVENT_TYPE, TYPE_SLICE_BEGIN);
+            pb_uint(&event, EVENT_TRACK_UUID, track);
+            pb_uint(&event, EVENT_NAME_IID, ev->kind == MLQ_EV_IDLE ? NAME_IDLE : NAME_FIRST_PID + (uint64_t)ev->pid);
+            if (ev->kind == MLQ_EV_DISPATCH) pb_annotation(&event, ANNOTATION_LEVEL, NULL, ev->queue_level);
+            perfetto_packet(t, ev->time, &event, intern);
+            event.len = 0;
+            pb_uint(&event, EVENT_TYPE, TYPE_SLICE_END);
+            pb_uint(&event, EVENT_TRACK_UUID, track);
+            perfetto_packet(t, ev->time + ev->duration, &event, -1);
+            break;
+        case MLQ_EV_ARRIVE:
+            if (needs_name(t, ev->pid)) intern = ev->pid;
+            pb_uint(&event, EVENT_TYPE, TYPE_INSTANT);
+            pb_uint(&event, EVENT_TRACK_UUID, track);
+            pb_uint(&event, EVENT_NAME_IID, NAME_FIRST_PID + (uint64_t)ev->pid);
+            pb_annotation(&event, ANNOTATION_LEVEL, NULL, ev->queue_level);
+            perfetto_packet(t, ev->time, &event, intern);
+            break;
+        case MLQ_EV_PROMOTE:
+        case MLQ_EV_DEMOTE:
+        case MLQ_EV_COMPLETE:
+        case MLQ_EV_MIGRATE:
+        case MLQ_EV_PREEMPT:
+            mlq_process_name(ev->pid, name, sizeof(name));
+            pb_uint(&event, EVENT_TYPE, TYPE_INSTANT);
+            pb_uint(&event, EVENT_TRACK_UUID, track);
+            pb_uint(&event, EVENT_NAME_IID, instants[ev->kind]);
+            pb_annotation(&event, ANNOTATION_PROCESS, name, 0);
+            pb_annotation(&event, ANNOTATION_LEVEL, NULL, ev->queue_level);
+            perfetto_packet(t, ev->time, &event, -1);
+            break;
+    }
+}
+
+int mlq_trace_open(MlqTrace *t, const char *path, MlqTraceFormat format, int compress, const MlqSim *sim) {
+    memset(t, 0, sizeof(*t));
+    t->format = format;
+    t->sim = sim;
+    if (compress && !mlq_trace_can_compress()) return -1;
+    t->buf = malloc(MLQ_TRACE_BUFFER);
+    if (!t->buf) return -1;
+#ifdef MLQ_ZLIB
+    if (compress) t->gz = gzopen(path, "wb1");
+    else
+#endif
+    t->file = fopen(path, "wb");
+    if (!t->file && !t->gz) {
+        free(t->buf);
+        t->buf = NULL;
+        return -1;
+    }
+    if (format == MLQ_TRACE_JSON) json_header(t);
+    else perfetto_header(t);
+    return 0;
+}
+
+void mlq_trace_event(MlqTrace *t, const MlqEvent *ev) {
+    if (t->failed) return;
+    t->events++;
+    if (t->format == MLQ_TRACE_JSON) json_write(t, ev);
+    else perfetto_write(t, ev);
+}
+
+void mlq_trace_on_event(const MlqEvent *ev, void *user) {
+    mlq_trace_event(user, ev);
+}
+
+int mlq_trace_close(MlqTrace *t) {
+    if (t->format == MLQ_TRACE_JSON) {
+        const char *tail = "\n]}\n";
+        memcpy(reserve(t, strlen(tail)), tail, strlen(tail));
+        t->len += strlen(tail);
+    }
+    flush_buffer(t);
+#ifdef MLQ_ZLIB
+    if (t->gz && gzclose((gzFile)t->gz) != Z_OK) t->failed = 1;
+#endif
+    if (t->file && fclose(t->file) != 0) t->failed = 1;
+    int status = t->failed ? -1 : 0;
+    free(t->buf);
+    free(t->named);
+    memset(t, 0, sizeof(*t));
+    return status;
+}
@@ -0,0 +1,48 @@
+#ifndef MLQ_TRACE_H
+#define MLQ_TRACE_H
+
+#include <stdio.h>
+
+#include "mlq_engine.h"
+
+#define MLQ_TRACE_BUFFER (64 * 1024)    // bytes formatted before each write
+
+typedef enum {
+    MLQ_TRACE_JSON,             // Chrome trace-event JSON (chrome://tracing, Perfetto UI)
+    MLQ_TRACE_PERFETTO          // Perfetto protobuf TracePackets
+} MlqTraceFormat;
+
+// Streams engine events to a trace file as they happen; nothing is kept
+// but the write buffer and, for Perfetto, which process names have been
+// interned. Each CPU is a track of run and idle slices with level
+// changes, completions, migrations and preemptions as instants on it;
+// arrivals get a track of their own. One tick is written as one
+// microsecond.
+typedef struct {
+    MlqTraceFormat format;
+    const MlqSim *sim;
+    FILE *file;
+    void *gz;                   // gzFile when compressing
+    unsigned char *buf;
+    size_t len;
+    int failed;                 // a write failed; later events are dropped
+    long long events;
+    int first;                  // JSON: no comma before the next event
+
+    unsigned char *named;       // Perfetto: per pid, its name is interned
+    int named_capacity;
+} MlqTrace;
+
+// Whether this build can write .gz traces (compiled with MLQ_ZLIB)
+int mlq_trace_can_compress(void);
+
+int mlq_trace_parse_format(const char *name, MlqTraceFormat *format);
+
+// Writes the header and one track per CPU of `sim`; compress gzips the file
+int mlq_trace_open(MlqTrace *t, const char *path, MlqTraceFormat format, int compress, const MlqSim *sim);
+void mlq_trace_event(MlqTrace *t, const MlqEvent *ev);
+void mlq_trace_on_event(const MlqEvent *ev, void *user);
+// Finishes the file; returns -1 if any write failed
+int mlq_trace_close(MlqTrace *t);
+
+#endif
@@ -0,0 +1,359 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mlq_workload.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BINARY_HEADER_BYTES 16
+#define BINARY_RECORD_BYTES 12
+
+int mlq_map_file(MlqMappedFile *mf, const char *path) {
+    memset(mf, 0, sizeof(*mf));
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return -1;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return -1;
+    }
+    mf->file_handle = file;
+    mf->size = (size_t)size.QuadPart;
+    if (mf->size == 0) return 0;
+
+    HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!map) {
+        CloseHandle(file);
+        return -1;
+    }
+    mf->map_handle = map;
+    mf->data = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (!mf->data) {
+        CloseHandle(map);
+        CloseHandle(file);
+        return -1;
+    }
+    return 0;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    mf->size = (size_t)st.st_size;
+    if (mf->size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void *data = mmap(NULL, mf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return -1;
+    posix_madvise(data, mf->size, POSIX_MADV_SEQUENTIAL);
+    mf->data = data;
+    return 0;
+#endif
+}
+
+void mlq_unmap_file(MlqMappedFile *mf) {
+#ifdef _WIN32
+    if (mf->data) UnmapViewOfFile(mf->data);
+    if (mf->map_handle) CloseHandle(mf->map_handle);
+    if (mf->file_handle) CloseHandle(mf->file_handle);
+#else
+    if (mf->data) munmap((void *)mf->data, mf->size);
+#endif
+    memset(mf, 0, sizeof(*mf));
+}
+
+void mlq_workload_init(MlqWorkload *wl) {
+    memset(wl, 0, sizeof(*wl));
+}
+
+void mlq_workload_free(MlqWorkload *wl) {
+    free(wl->jobs);
+    memset(wl, 0, sizeof(*wl));
+}
+
+int mlq_workload_reserve(MlqWorkload *wl, int capacity) {
+    if (capacity <= wl->capacity) return 0;
+    MlqJob *grown = realloc(wl->jobs, sizeof(MlqJob) * capacity);
+    if (!grown) return -1;
+    wl->jobs = grown;
+    wl->capacity = capacity;
+    return 0;
+}
+
+int mlq_workload_push(MlqWorkload *wl, int arrival_time, int burst_time, int priority) {
+    if (wl->count == wl->capacity &&
+        mlq_workload_reserve(wl, wl->capacity ? wl->capacity * 2 : 1024) < 0) {
+        return -1;
+    }
+    MlqJob *job = &wl->jobs[wl->count++];
+    job->arrival_time = arrival_time;
+    job->burst_time = burst_time;
+    job->priority = priority;
+    return 0;
+}
+
+// Parse one integer field, then skip the separator that follows it
+static int parse_field(const char **cursor, const char *end, int *out) {
+    const char *p = *cursor;
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+
+    int negative = 0;
+    if (p < end && *p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (p >= end || *p < '0' || *p > '9') return -1;
+
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        if (v > INT_MAX) return -1;
+        p++;
+    }
+
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    if (p < end && *p == ',') p++;
+    *out = (int)(negative ? -v : v);
+    *cursor = p;
+    return 0;
+}
+
+int mlq_workload_load_csv(MlqWorkload *wl, const char *path) {
+    MlqMappedFile mf;
+    if (mlq_map_file(&mf, path) < 0) {
+        perror(path);
+        return -1;
+    }
+
+    const char *p = mf.data;
+    const char *end = mf.data + mf.size;
+    int line = 0;
+    int seen_content = 0;
+    while (p < end) {
+        line++;
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        if (!eol) eol = end;
+
+        const char *q = p;
+        while (q < eol && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+        int first_content = !seen_content;
+        if (q < eol) seen_content = 1;
+
+        if (q < eol && *q != '#') {
+            const char *start = q;
+            int fields[3];
+            int ok = 1;
+            for (int f = 0; f < 3 && ok; f++) ok = parse_field(&q, eol, &fields[f]) == 0;
+            if (!ok || q != eol) {
+                // A leading column-name row is fine; anything else is an error
+                if (!(first_content && (*start < '0' || *start > '9') && *start != '-')) {
+                    fprintf(stderr, "%s:%d: expected <arrival>,<burst>,<priority>\n", path, line);
+                    mlq_unmap_file(&mf);
+                    return -1;
+                }
+            } else if (mlq_workload_push(wl, fields[0], fields[1], fields[2]) < 0) {
+                fprintf(stderr, "out of memory\n");
+                mlq_unmap_file(&mf);
+                return -1;
+            }
+        }
+        p = eol + 1;
+    }
+
+    mlq_unmap_file(&mf);
+    return 0;
+}
+
+static int32_t read_le32(const unsigned char *b) {
+    return (int32_t)((uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24);
+}
+
+static void write_le32(unsigned char *b, uint32_t v) {
+    b[0] = (unsigned char)v;
+    b[1] = (unsigned char)(v >> 8);
+    b[2] = (unsigned char)(v >> 16);
+    b[3] = (unsigned char)(v >> 24);
+}
+
+static int is_binary(const MlqMappedFile *mf) {
+    return mf->size >= BINARY_HEADER_BYTES && memcmp(mf->data, "MLQW", 4) == 0;
+}
+
+int mlq_workload_load_binary(MlqWorkload *wl, const char *path) {
+    MlqMappedFile mf;
+    if (mlq_map_file(&mf, path) < 0) {
+        perror(path);
+        return -1;
+    }
+
+    const unsigned char *b = (const unsigned char *)mf.data;
+    if (!is_binary(&mf) || read_le32(b + 4) != 1 || read_le32(b + 8) != BINARY_RECORD_BYTES ||
+        (mf.size - BINARY_HEADER_BYTES) % BINARY_RECORD_BYTES != 0) {
+        fprintf(stderr, "%s: not an MLQW version 1 workload\n", path);
+        mlq_unmap_file(&mf);
+        return -1;
+    }
+
+    size_t records = (mf.size - BINARY_HEADER_BYTES) / BINARY_RECORD_BYTES;
+    if (records > (size_t)(INT_MAX - wl->count) || mlq_workload_reserve(wl, wl->count + (int)records) < 0) {
+        fprintf(stderr, "%s: too many jobs\n", path);
+        mlq_unmap_file(&mf);
+        return -1;
+    }
+
+    b += BINARY_HEADER_BYTES;
+    MlqJob *job = &wl->jobs[wl->count];
+    for (size_t i = 0; i < records; i++, b += BINARY_RECORD_BYTES, job++) {
+        job->arrival_time = read_le32(b);
+        job->burst_time = read_le32(b + 4);
+        job->priority = read_le32(b + 8);
+    }
+    wl->count += (int)records;
+
+    mlq_unmap_file(&mf);
+    return 0;
+}
+
+int mlq_workload_save_binary(const MlqWorkload *wl, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    unsigned char header[BINARY_HEADER_BYTES];
+    memcpy(header, "MLQW", 4);
+    write_le32(header + 4, 1);
+    write_le32(header + 8, BINARY_RECORD_BYTES);
+    write_le32(header + 12, 0);
+    int ok = fwrite(header, sizeof(header), 1, f) == 1;
+
+    // Encode in blocks so the file is written with few large fwrites
+    unsigned char block[BINARY_RECORD_BYTES * 4096];
+    int i = 0;
+    while (ok && i < wl->count) {
+        int n = 0;
+        for (; n < 4096 && i < wl->count; n++, i++) {
+            unsigned char *r = block + n * BINARY_RECORD_BYTES;
+            write_le32(r, (uint32_t)wl->jobs[i].arrival_time);
+            write_le32(r + 4, (uint32_t)wl->jobs[i].burst_time);
+            write_le32(r + 8, (uint32_t)wl->jobs[i].priority);
+        }
+        ok = fwrite(block, BINARY_RECORD_BYTES, (size_t)n, f) == (size_t)n;
+    }
+
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "%s: write failed\n", path);
+    return ok ? 0 : -1;
+}
+
+int mlq_workload_load(MlqWorkload *wl, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    char magic[4];
+    int binary = fread(magic, 1, 4, f) == 4 && memcmp(magic, "MLQW", 4) == 0;
+    fclose(f);
+    return binary ? mlq_workload_load_binary(wl, path) : mlq_workload_load_csv(wl, path);
+}
+
+void mlq_gen_params_default(MlqGenParams *params) {
+    params->seed = 1;
+    params->count = 1000;
+    params->mean_interarrival = 4.0;
+    params->burst_alpha = 1.5;
+    params->burst_min = 1;
+    params->burst_max = 1000;
+    params->priority_mix[0] = 0.2;
+    params->priority_mix[1] = 0.5;
+    params->priority_mix[2] = 0.3;
+}
+
+// splitmix64: tiny, seedable and good enough for workload shapes
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+static double next_unit(uint64_t *state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int mlq_workload_generate(MlqWorkload *wl, const MlqGenParams *params) {
+    if (params->count < 0 || params->burst_min < 1 || params->burst_max < params->burst_min ||
+        params->burst_alpha <= 0 || params->mean_interarrival < 0) {
+        return -1;
+    }
+    if (mlq_workload_reserve(wl, wl->count + params->count) < 0) return -1;
+
+    double total_weight = 0;
+    for (int q = 0; q < NUM_QUEUES; q++) total_weight += params->priority_mix[q] > 0 ? params->priority_mix[q] : 0;
+    if (total_weight <= 0) return -1;
+
+    uint64_t state = params->seed;
+    double lo = pow(params->burst_min, params->burst_alpha);
+    double hi = pow(params->burst_max, params->burst_alpha);
+    double t = 0;
+
+    for (int i = 0; i < params->count; i++) {
+        // Exponential gaps give a Poisson arrival process
+        t += -params->mean_interarrival * log(1.0 - next_unit(&state));
+        if (t > INT_MAX) return -1;
+
+        // Inverse CDF of the Pareto distribution bounded to [burst_min, burst_max]
+        double u = next_unit(&state);
+        double burst = pow(-(u * hi - u * lo - hi) / (hi * lo), -1.0 / params->burst_alpha);
+        int bt = (int)(burst + 0.5);
+        if (bt < params->burst_min) bt = params->burst_min;
+        if (bt > params->burst_max) bt = params->burst_max;
+
+        double pick = next_unit(&state) * total_weight;
+        int priority = NUM_QUEUES;
+        for (int q = 0; q < NUM_QUEUES; q++) {
+            double w = params->priority_mix[q] > 0 ? params->priority_mix[q] : 0;
+            if (pick < w) {
+                priority = q + 1;
+                break;
+            }
+            pick -= w;
+        }
+
+        mlq_workload_push(wl, (int)t, bt, priority);
+    }
+    return 0;
+}
+
+int mlq_sim_load_workload(MlqSim *sim, const MlqWorkload *wl) {
+    mlq_sim_clear_processes(sim);
+    if (mlq_sim_reserve(sim, wl->count) < 0) return -1;
+    for (int i = 0; i < wl->count; i++) {
+        const MlqJob *job = &wl->jobs[i];
+        if (mlq_sim_add_process(sim, job->arrival_time, job->burst_time, job->priority) < 0) return -1;
+    }
+    return 0;
+}
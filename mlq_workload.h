@@ -0,0 +1,71 @@
+#ifndef MLQ_WORKLOAD_H
+#define MLQ_WORKLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mlq_engine.h"
+
+// One job of a trace: what a row of the GTK grid used to hold
+typedef struct {
+    int arrival_time;
+    int burst_time;
+    int priority;
+} MlqJob;
+
+typedef struct {
+    MlqJob *jobs;
+    int count;
+    int capacity;
+} MlqWorkload;
+
+// Read-only view of a whole file, mmap'ed where the platform allows
+typedef struct {
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    void *file_handle;
+    void *map_handle;
+#endif
+} MlqMappedFile;
+
+int mlq_map_file(MlqMappedFile *mf, const char *path);
+void mlq_unmap_file(MlqMappedFile *mf);
+
+void mlq_workload_init(MlqWorkload *wl);
+void mlq_workload_free(MlqWorkload *wl);
+int mlq_workload_reserve(MlqWorkload *wl, int capacity);
+int mlq_workload_push(MlqWorkload *wl, int arrival_time, int burst_time, int priority);
+
+// CSV: "arrival,burst,priority" per line; spaces also separate fields, so
+// the old "<arrival> <burst> <priority>" files still load. Lines starting
+// with '#' and a non-numeric header line are skipped.
+int mlq_workload_load_csv(MlqWorkload *wl, const char *path);
+
+// Fixed-record binary: 16-byte header ("MLQW", version, record size,
+// reserved) then little-endian int32 arrival, burst, priority per job
+int mlq_workload_load_binary(MlqWorkload *wl, const char *path);
+int mlq_workload_save_binary(const MlqWorkload *wl, const char *path);
+
+// Picks the format from the file's magic bytes
+int mlq_workload_load(MlqWorkload *wl, const char *path);
+
+// Seeded synthetic workload: Poisson arrivals, bounded-Pareto bursts and
+// a weighted priority mix. The same parameters give the same trace.
+typedef struct {
+    uint64_t seed;
+    int count;
+    double mean_interarrival;   // ticks between arrivals on average
+    double burst_alpha;         // Pareto shape; smaller is heavier-tailed
+    int burst_min;
+    int burst_max;
+    double priority_mix[NUM_QUEUES];    // relative weight per level
+} MlqGenParams;
+
+void mlq_gen_params_default(MlqGenParams *params);
+int mlq_workload_generate(MlqWorkload *wl, const MlqGenParams *params);
+
+// Replace the simulator's processes with the workload's jobs
+int mlq_sim_load_workload(MlqSim *sim, const MlqWorkload *wl);
+
+#endif
@@ -0,0 +1,285 @@
+#include "mlq_zoom.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void mlq_zoom_init(MlqZoomIndex *zi) {
+    memset(zi, 0, sizeof(*zi));
+}
+
+void mlq_zoom_free(MlqZoomIndex *zi) {
+    for (int c = 0; c < zi->lane_count; c++) {
+        for (int level = 0; level < MLQ_ZOOM_LEVELS; level++) free(zi->lanes[c].levels[level].runs);
+    }
+    free(zi->lanes);
+    memset(zi, 0, sizeof(*zi));
+}
+
+void mlq_zoom_clear(MlqZoomIndex *zi) {
+    for (int c = 0; c < zi->lane_count; c++) {
+        MlqZoomLane *ln = &zi->lanes[c];
+        for (int level = 0; level < MLQ_ZOOM_LEVELS; level++) {
+            ln->levels[level].count = 0;
+            ln->levels[level].open = 0;
+        }
+        ln->tally_count = 0;
+    }
+    zi->ingested = 0;
+    zi->end_time = 0;
+}
+
+static int add_lanes(MlqZoomIndex *zi, int lanes) {
+    MlqZoomLane *grown = realloc(zi->lanes, sizeof(MlqZoomLane) * lanes);
+    if (!grown) return -1;
+    memset(grown + zi->lane_count, 0, sizeof(MlqZoomLane) * (lanes - zi->lane_count));
+    zi->lanes = grown;
+    zi->lane_count = lanes;
+    return 0;
+}
+
+// Append an empty run; NULL when out of memory
+static MlqZoomRun *push_run(MlqZoomLevel *lv, int first, int count) {
+    if (lv->count == lv->capacity) {
+        int cap = lv->capacity ? lv->capacity * 2 : 64;
+        MlqZoomRun *grown = realloc(lv->runs, sizeof(MlqZoomRun) * cap);
+        if (!grown) return NULL;
+        lv->runs = grown;
+        lv->capacity = cap;
+    }
+    MlqZoomRun *run = &lv->runs[lv->count++];
+    memset(run, 0, sizeof(*run));
+    run->first = first;
+    run->count = count;
+    for (int i = 0; i < MLQ_ZOOM_TOP; i++) run->bucket.top[i].pid = -1;
+    run->first_slice = -1;
+    run->last_slice = -1;
+    return run;
+}
+
+// Keep the MLQ_ZOOM_TOP largest of `all`, most ticks first (earlier
+// entries win ties), less the next largest count: the Misra-Gries merge.
+// Entries that drop to zero stay as the best guess while nothing beats them.
+static void keep_top(MlqZoomCount *top, MlqZoomCount *all, int n) {
+    for (int i = 1; i < n; i++) {
+        MlqZoomCount x = all[i];
+        int j = i;
+        for (; j > 0 && all[j - 1].ticks < x.ticks; j--) all[j] = all[j - 1];
+        all[j] = x;
+    }
+    int cut = n > MLQ_ZOOM_TOP ? all[MLQ_ZOOM_TOP].ticks : 0;
+    for (int i = 0; i < MLQ_ZOOM_TOP; i++) {
+        top[i].pid = i < n ? all[i].pid : -1;
+        top[i].ticks = i < n ? all[i].ticks - cut : 0;
+    }
+}
+
+// dst += mult copies of src
+static void merge_bucket(MlqZoomBucket *dst, const MlqZoomBucket *src, int mult) {
+    dst->busy += src->busy * mult;
+    for (int q = 0; q < NUM_QUEUES; q++) dst->level_ticks[q] += src->level_ticks[q] * mult;
+
+    MlqZoomCount all[2 * MLQ_ZOOM_TOP];
+    int n = 0;
+    for (int i = 0; i < MLQ_ZOOM_TOP && dst->top[i].pid >= 0; i++) all[n++] = dst->top[i];
+    for (int i = 0; i < MLQ_ZOOM_TOP && src->top[i].pid >= 0; i++) {
+        int j = 0;
+        while (j < n && all[j].pid != src->top[i].pid) j++;
+        if (j == n) {
+            all[n].pid = src->top[i].pid;
+            all[n++].ticks = 0;
+        }
+        all[j].ticks += src->top[i].ticks * mult;
+    }
+    keep_top(dst->top, all, n);
+}
+
+static int feed(MlqZoomLane *ln, int level, int first, int n, const MlqZoomBucket *child);
+
+// The level's open bucket is complete: hand it to the level above
+static int close_open(MlqZoomLane *ln, int level) {
+    MlqZoomLevel *lv = &ln->levels[level];
+    if (!lv->open) return 0;
+    lv->open = 0;
+    MlqZoomRun run = lv->runs[lv->count - 1];
+    return feed(ln, level + 1, run.first, 1, &run.bucket);
+}
+
+// Make bucket b the level's open bucket, closing an earlier one
+static MlqZoomRun *open_bucket(MlqZoomLane *ln, int level, int b) {
+    MlqZoomLevel *lv = &ln->levels[level];
+    if (lv->open && lv->runs[lv->count - 1].first == b) return &lv->runs[lv->count - 1];
+    if (close_open(ln, level) < 0) return NULL;
+    MlqZoomRun *run = push_run(lv, b, 1);
+    if (!run) return NULL;
+    lv->open = 1;
+    if (level == 0) ln->tally_count = 0;
+    return run;
+}
+
+// Children [first, first + n) of `level`, all equal to `child`, have
+// closed on the level below. Partly covered parents merge them into the
+// open bucket; parents covered whole become one closed run and move up
+// at once.
+static int feed(MlqZoomLane *ln, int level, int first, int n, const MlqZoomBucket *child) {
+    if (level == MLQ_ZOOM_LEVELS) return 0;
+    int p0 = first >> 1;
+    int p1 = (first + n - 1) >> 1;
+    MlqZoomRun *run = open_bucket(ln, level, p0);
+    if (!run) return -1;
+    merge_bucket(&run->bucket, child, p0 == p1 ? n : 2 * p0 + 2 - first);
+    if (p0 == p1) return 0;
+
+    if (close_open(ln, level) < 0) return -1;
+    if (p1 - p0 > 1) {
+        MlqZoomBucket twice;
+        memset(&twice, 0, sizeof(twice));
+        for (int i = 0; i < MLQ_ZOOM_TOP; i++) twice.top[i].pid = -1;
+        merge_bucket(&twice, child, 2);
+        MlqZoomRun *full = push_run(&ln->levels[level], p0 + 1, p1 - p0 - 1);
+        if (!full) return -1;
+        full->bucket = twice;
+        if (feed(ln, level + 1, p0 + 1, p1 - p0 - 1, &twice) < 0) return -1;
+    }
+    run = open_bucket(ln, level, p1);
+    if (!run) return -1;
+    merge_bucket(&run->bucket, child, first + n - 2 * p1);
+    return 0;
+}
+
+// Exact per-process ticks while a finest bucket fills
+static int add_finest(MlqZoomLane *ln, int b, int ticks, const MlqSlice *slice, long long index) {
+    MlqZoomRun *run = open_bucket(ln, 0, b);
+    if (!run) return -1;
+    if (run->first_slice < 0) run->first_slice = index;
+    run->last_slice = index;
+    MlqZoomBucket *bk = &run->bucket;
+    bk->busy += ticks;
+    if (slice->queue_level >= 1 && slice->queue_level <= NUM_QUEUES) bk->level_ticks[slice->queue_level - 1] += ticks;
+
+    int i = 0;
+    while (i < ln->tally_count && ln->tally[i].pid != slice->pid) i++;
+    if (i == ln->tally_count) {
+        ln->tally[i].pid = slice->pid;
+        ln->tally[i].ticks = 0;
+        ln->tally_count++;
+    }
+    ln->tally[i].ticks += ticks;
+
+    MlqZoomCount all[1 << MLQ_ZOOM_BASE_SHIFT];
+    memcpy(all, ln->tally, sizeof(MlqZoomCount) * ln->tally_count);
+    keep_top(bk->top, all, ln->tally_count < MLQ_ZOOM_TOP ? ln->tally_count : MLQ_ZOOM_TOP);
+    for (int k = MLQ_ZOOM_TOP; k < ln->tally_count; k++) {
+        // Exact, so no Misra-Gries cut: place the rest by insertion
+        MlqZoomCount x = all[k];
+        for (int j = 0; j < MLQ_ZOOM_TOP; j++) {
+            if (x.ticks <= bk->top[j].ticks) continue;
+            MlqZoomCount y = bk->top[j];
+            bk->top[j] = x;
+            x = y;
+        }
+    }
+    return 0;
+}
+
+// Close every open bucket that ends by `time`. Slices on a lane come in
+// time order, so nothing more can land in them.
+static int settle(MlqZoomLane *ln, long long time) {
+    for (int level = 0; level < MLQ_ZOOM_LEVELS; level++) {
+        MlqZoomLevel *lv = &ln->levels[level];
+        if (!lv->open) continue;
+        long long edge = (long long)(lv->runs[lv->count - 1].first + 1) << (MLQ_ZOOM_BASE_SHIFT + level);
+        if (edge <= time && close_open(ln, level) < 0) return -1;
+    }
+    return 0;
+}
+
+int mlq_zoom_add(MlqZoomIndex *zi, const MlqSlice *slice, long long index) {
+    if (slice->duration <= 0) return 0;
+    long long start = slice->start_time;
+    long long end = start + slice->duration;
+    if (end > zi->end_time) zi->end_time = (int)end;
+    if (slice->pid < 0) {
+        return slice->cpu < zi->lane_count ? settle(&zi->lanes[slice->cpu], end) : 0;
+    }
+    if (slice->cpu >= zi->lane_count && add_lanes(zi, slice->cpu + 1) < 0) return -1;
+
+    MlqZoomLane *ln = &zi->lanes[slice->cpu];
+    if (settle(ln, start) < 0) return -1;
+    int first = (int)(start >> MLQ_ZOOM_BASE_SHIFT);
+    int last = (int)((end - 1) >> MLQ_ZOOM_BASE_SHIFT);
+    long long edge = (long long)(first + 1) << MLQ_ZOOM_BASE_SHIFT;
+    if (add_finest(ln, first, (int)((end < edge ? end : edge) - start), slice, index) < 0) return -1;
+    if (first == last) return 0;
+
+    if (close_open(ln, 0) < 0) return -1;
+    if (last - first > 1) {
+        MlqZoomRun *full = push_run(&ln->levels[0], first + 1, last - first - 1);
+        if (!full) return -1;
+        full->bucket.busy = 1 << MLQ_ZOOM_BASE_SHIFT;
+        if (slice->queue_level >= 1 && slice->queue_level <= NUM_QUEUES) {
+            full->bucket.level_ticks[slice->queue_level - 1] = 1 << MLQ_ZOOM_BASE_SHIFT;
+        }
+        full->bucket.top[0].pid = slice->pid;
+        full->bucket.top[0].ticks = 1 << MLQ_ZOOM_BASE_SHIFT;
+        full->first_slice = index;
+        full->last_slice = index;
+        MlqZoomBucket bucket = full->bucket;
+        if (feed(ln, 1, first + 1, last - first - 1, &bucket) < 0) return -1;
+    }
+    return add_finest(ln, last, (int)(end - ((long long)last << MLQ_ZOOM_BASE_SHIFT)), slice, index);
+}
+
+int mlq_zoom_sync(MlqZoomIndex *zi, MlqTimeline *tl) {
+    if (tl->count < zi->ingested) mlq_zoom_clear(zi);
+    while (zi->ingested < tl->count) {
+        MlqSlice slice;
+        if (mlq_timeline_get(tl, zi->ingested, &slice) < 0) return -1;
+        if (mlq_zoom_add(zi, &slice, zi->ingested) < 0) return -1;
+        zi->ingested++;
+    }
+    return 0;
+}
+
+int mlq_zoom_level_for(double ticks_per_pixel) {
+    if (ticks_per_pixel < (double)(1 << MLQ_ZOOM_BASE_SHIFT)) return -1;
+    int level = 0;
+    while (level + 1 < MLQ_ZOOM_LEVELS &&
+           (double)(1LL << (MLQ_ZOOM_BASE_SHIFT + level + 1)) <= ticks_per_pixel) {
+        level++;
+    }
+    return level;
+}
+
+int mlq_zoom_runs(const MlqZoomIndex *zi, int lane, int level, int b0, int b1, const MlqZoomRun **runs) {
+    *runs = NULL;
+    if (lane < 0 || lane >= zi->lane_count || level < 0 || level >= MLQ_ZOOM_LEVELS || b1 < b0) return 0;
+    const MlqZoomLevel *lv = &zi->lanes[lane].levels[level];
+    int lo = 0, hi = lv->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (lv->runs[mid].first + lv->runs[mid].count <= b0) lo = mid + 1;
+        else hi = mid;
+    }
+    int end = lo;
+    while (end < lv->count && lv->runs[end].first <= b1) end++;
+    *runs = lv->runs + lo;
+    return end - lo;
+}
+
+int mlq_zoom_slice_range(const MlqZoomIndex *zi, int t0, int t1, long long *first, long long *last) {
+    if (t0 < 0) t0 = 0;
+    *first = -1;
+    *last = -1;
+    if (t1 <= t0) return -1;
+    int b0 = t0 >> MLQ_ZOOM_BASE_SHIFT;
+    int b1 = (t1 - 1) >> MLQ_ZOOM_BASE_SHIFT;
+    for (int c = 0; c < zi->lane_count; c++) {
+        const MlqZoomRun *runs;
+        int n = mlq_zoom_runs(zi, c, 0, b0, b1, &runs);
+        for (int i = 0; i < n; i++) {
+            if (*first < 0 || runs[i].first_slice < *first) *first = runs[i].first_slice;
+            if (runs[i].last_slice > *last) *last = runs[i].last_slice;
+        }
+    }
+    return *first < 0 ? -1 : 0;
+}
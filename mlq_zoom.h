@@ -0,0 +1,87 @@
+#ifndef MLQ_ZOOM_H
+#define MLQ_ZOOM_H
+
+#include "mlq_engine.h"
+#include "mlq_timeline.h"
+
+#define MLQ_ZOOM_BASE_SHIFT 6       // finest summary bucket: 64 ticks
+#define MLQ_ZOOM_LEVELS 25          // level L buckets span 2^(6 + L) ticks
+#define MLQ_ZOOM_TOP 4              // heavy hitters kept per bucket
+
+typedef struct {
+    int pid;                        // -1 marks an unused entry
+    int ticks;
+} MlqZoomCount;
+
+// What one lane did over one bucket of time. top[] is exact at the finest
+// level; above it, it is a Misra-Gries summary merged from the children,
+// so any process with more than 1/(MLQ_ZOOM_TOP + 1) of the busy ticks is
+// in it, and each count is short by at most that share.
+typedef struct {
+    int busy;                       // ticks spent running a process
+    int level_ticks[NUM_QUEUES];    // busy ticks per queue level
+    MlqZoomCount top[MLQ_ZOOM_TOP]; // most ticks first; top[0] is the dominant process
+} MlqZoomBucket;
+
+// `count` consecutive buckets from `first` that are all `bucket`. Only
+// buckets with something running are stored.
+typedef struct {
+    int first;
+    int count;
+    MlqZoomBucket bucket;
+    long long first_slice;          // finest level: timeline indices of the slices in it
+    long long last_slice;
+} MlqZoomRun;
+
+typedef struct {
+    MlqZoomRun *runs;               // in time order; the last may still be filling
+    int count;
+    int capacity;
+    int open;                       // the last run is one bucket still taking slices
+} MlqZoomLevel;
+
+typedef struct {
+    MlqZoomLevel levels[MLQ_ZOOM_LEVELS];
+    MlqZoomCount tally[1 << MLQ_ZOOM_BASE_SHIFT];  // per-process ticks of the open finest bucket
+    int tally_count;
+} MlqZoomLane;
+
+// Summary pyramid over a timeline: every level halves the resolution of
+// the one below, so any window can be drawn from the level whose buckets
+// are about a pixel wide. Slices are folded in as they are committed, in
+// time order per lane; idle slices are skipped, so the size follows the
+// busy slices, not the length of the run. A bucket reaches the level
+// above once it closes, so the newest bucket of each level trails by less
+// than its own width.
+typedef struct {
+    MlqZoomLane *lanes;
+    int lane_count;
+
+    long long ingested;             // timeline records folded in so far
+    int end_time;                   // latest slice end seen
+} MlqZoomIndex;
+
+void mlq_zoom_init(MlqZoomIndex *zi);
+void mlq_zoom_free(MlqZoomIndex *zi);
+void mlq_zoom_clear(MlqZoomIndex *zi);
+
+// Fold in one slice; `index` is its position in the timeline
+int mlq_zoom_add(MlqZoomIndex *zi, const MlqSlice *slice, long long index);
+
+// Fold in the timeline's newly committed slices. Starts over if the
+// timeline was cleared since the last call.
+int mlq_zoom_sync(MlqZoomIndex *zi, MlqTimeline *tl);
+
+// Coarsest level whose buckets are no wider than ticks_per_pixel, or -1
+// when the raw slices should be drawn instead
+int mlq_zoom_level_for(double ticks_per_pixel);
+
+// Runs of a lane's level that overlap buckets [b0, b1]: returns how many,
+// with *runs pointing at the first. Valid until the next add.
+int mlq_zoom_runs(const MlqZoomIndex *zi, int lane, int level, int b0, int b1, const MlqZoomRun **runs);
+
+// Range of timeline indices of busy slices that may overlap [t0, t1); -1
+// if none do
+int mlq_zoom_slice_range(const MlqZoomIndex *zi, int t0, int t1, long long *first, long long *last);
+
+#endif